@@ -1,45 +1,102 @@
 #include <math.h>
+#include <algorithm>
+#include <utility>
 
 #include "DCT.hpp" 
+#include "DCTKernel.hpp"
 #include "FMatrix.hpp"
+#include "ThreadPool.hpp"
+
+namespace {
+  // the largest distance of the samples from the level shift and the largest
+  // dequantised coefficients the 32 bit integer kernels take. Every
+  // intermediate of the kernels is a sum of the inputs times constants; the
+  // sum of the absolute constants times these limits stays below 2^31
+  const double FORWARD_INT_LIMIT = 799;
+  const double INVERSE_INT_LIMIT = 1173;
+
+  // the inputs of the 64 bit kernels are clamped to these limits - they are
+  // far beyond what a picture of 16 bit or a file of the encoder gives, but
+  // keep the intermediates below 2^62 and the coefficients of the forward
+  // kernel times the quality in percent below 2^52
+  const double FORWARD_WIDE_LIMIT = 16777216.0;
+  const double INVERSE_WIDE_LIMIT = 1099511627776.0;
+
+  // numerator / denominator rounded to the nearest integer - halfway cases
+  // away from zero. |numerator| and denominator have to be integers below
+  // 2^52 for both types of T, so the division of doubles never rounds the
+  // quotient up to the next integer and the truncated quotient is the exact
+  // one. The truncation to T keeps the loops over a block free of branches
+  // and lets the compiler vectorize them
+  template <typename T>
+  inline double divide(const double &numerator, const double &denominator) {
+    return copysign((T)((fabs(numerator) + denominator / 2) / denominator),
+                    numerator);
+  }
+}
 
 // Default constructor
 DCT::DCT() {
   quality_ = 1;
+  method_ = FLOAT;
   mat_pic_ = NULL; 
   color_depth_= 0;
   quantization_ = new Matrix<unsigned char>(8);
   create_default_quantisation();
-  transformation_ = new Matrix<double>(8);
-  make_transformation_matrix();
 }
 
 // constructor with an image matrix and a color depth to transform the image
 // matrix
-DCT::DCT(const Matrix<Pixel<double> > &data, const unsigned int &color_depth) {
+DCT::DCT(const Image<double> &data, const unsigned int &color_depth) {
   quality_ = 1;
+  method_ = FLOAT;
   color_depth_ = color_depth;
-  mat_pic_ = new Matrix<Pixel<double> >(data);
+  mat_pic_ = new Image<double>(data);
   quantization_ = new Matrix<unsigned char>(8);
   create_default_quantisation();
-  transformation_ = new Matrix<double>(8);
-  make_transformation_matrix();
 }
 
-// copy constructor
+// constructor that takes over an image matrix without copying it
+DCT::DCT(Image<double> &&data, const unsigned int &color_depth) {
+  quality_ = 1;
+  method_ = FLOAT;
+  color_depth_ = color_depth;
+  mat_pic_ = new Image<double>(std::move(data));
+  quantization_ = new Matrix<unsigned char>(8);
+  create_default_quantisation();
+}
+
+// copy constructor - a DCT that was moved from or whose image matrix was
+// released is copied without the missing parts
 DCT::DCT(const DCT &copy) { 
-  quality_ = copy.get_quality(); 
+  quality_ = copy.quality_;
+  method_ = copy.method_;
   color_depth_ = copy.get_color_depth();
-  mat_pic_ = new Matrix<Pixel<double> >(copy.get_mat_pic());
-  quantization_ = new Matrix<unsigned char>(copy.get_quantization()); 
-  transformation_ = new Matrix<double>(8);
-  make_transformation_matrix();
+  mat_pic_ = NULL;
+  quantization_ = NULL;
+
+  if(copy.mat_pic_ != NULL) {
+    mat_pic_ = new Image<double>(copy.get_mat_pic());
+  }
+  if(copy.quantization_ != NULL) {
+    quantization_ = new Matrix<unsigned char>(copy.get_quantization()); 
+  }
+}
+
+// move constructor
+DCT::DCT(DCT &&other) {
+  quality_ = other.quality_;
+  method_ = other.method_;
+  color_depth_ = other.color_depth_;
+  mat_pic_ = other.mat_pic_;
+  quantization_ = other.quantization_;
+  other.mat_pic_ = NULL;
+  other.quantization_ = NULL;
 }
 
 //destructor
 DCT::~DCT() {
   delete mat_pic_;
-  delete transformation_;
   delete quantization_;
 }
  
@@ -47,40 +104,46 @@ DCT::~DCT() {
 void DCT::forward_dct() {
   unsigned int width = mat_pic_->get_col_length();
   unsigned int height = mat_pic_->get_row_length();
-  Pixel<double> emptyPix = Pixel<double>(mat_pic_->get_data(0,0).size(), 0);
-  Matrix<Pixel<double> > mat_buffer = Matrix<Pixel<double> >(8);
-  Matrix<Pixel<double> > trans = Matrix<Pixel<double> >(8, 8, emptyPix);
-  trans += *transformation_;
-
-  for(unsigned int i = 0; i < height; i += 8) {
-    for(unsigned int j = 0; j < width; j += 8) {
-
-      for(unsigned int k = i, k_end = i + 8; k < k_end; ++k) {
-        for(unsigned int l = j, l_end = j + 8; l < l_end; ++l) {
-          if(k >= height || l >= width) { 
-            mat_buffer.set_data(k - i, l - j, emptyPix);
-          } else {
-            mat_buffer.set_data(k - i, l - j, mat_pic_->get_data(k, l));
-          }
-        }
-      }
+  Block table;
+  Block numerators;
+  Block denominators;
+  // the level shift of all 64 samples only moves the DC coefficient
+  double dc_shift = 64.0 * get_level_shift();
+
+  make_forward_table(table);
+  make_forward_fractions(numerators, denominators);
+
+  for(Matrix<double> &plane : *mat_pic_) {
+    plane.advise(0, height, MappedFile::SEQUENTIAL);
+
+    // the stripes of 8 rows are independent - every block is transformed
+    // the same on any thread, so the result does not depend on their amount
+    ThreadPool::get_default().parallel_for((height + 7) / 8, 1,
+        [&](unsigned int begin, unsigned int end) {
+          Block mat_buffer;
+
+          for(unsigned int i = begin * 8; i < end * 8; i += 8) {
+            for(unsigned int j = 0; j < width; j += 8) {
+              load_block(plane, i, j, mat_buffer);
+
+              if(method_ == ISLOW) {
+                forward_islow(mat_buffer, numerators, denominators);
+              } else {
+                DCTKernel::forward(mat_buffer.get_row(0));
 
-      mat_buffer = mat_buffer - 128;
+                mat_buffer(0, 0) -= dc_shift;
 
-      mat_buffer = trans.transpose() * mat_buffer * trans;
+                scale(mat_buffer, table); 
 
-      quantisation(mat_buffer, *quantization_, quality_); 
+                round(mat_buffer);
+              }
 
-      round(mat_buffer);
-      
-      for(unsigned int k = i, k_end = i + 8; k < k_end; ++k) {
-        for(unsigned int l = j, l_end = j + 8; l < l_end; ++l) {
-          if(k < height && l < width) { 
-            mat_pic_->set_data(k, l, mat_buffer.get_data(k - i, l - j));
+              store_block(plane, i, j, mat_buffer);
+            }
+            // a file backed plane only keeps the stripes in work resident
+            plane.advise(i, i + 8, MappedFile::DONT_NEED);
           }
-        }
-      }
-    }
+        });
   }
 }
 
@@ -88,42 +151,45 @@ void DCT::forward_dct() {
 void DCT::inverse_dct() {
   unsigned int width = mat_pic_->get_col_length();
   unsigned int height = mat_pic_->get_row_length();
-  Pixel<double> emptyPix = Pixel<double>(mat_pic_->get_data(0,0).size(), 0);
-  Matrix<Pixel<double> > mat_buffer = Matrix<Pixel<double> >(8);
-  Matrix<Pixel<double> > trans = Matrix<Pixel<double> >(8, 8, emptyPix); 
-  trans += *transformation_;
-
-  for(unsigned int i = 0; i < height; i += 8) {
-    for(unsigned int j = 0; j < width; j += 8) {
-
-      for(unsigned int k = i, k_end = i + 8; k < k_end; ++k) {
-        for(unsigned int l = j, l_end = j + 8; l < l_end; ++l) {
-          if(k >= height || l >= width) { 
-            mat_buffer.set_data(k - i, l - j, emptyPix);
-          } else {
-            mat_buffer.set_data(k - i, l - j, mat_pic_->get_data(k, l));
-          }
-        }
-      }
+  Block table;
+  Block numerators;
+  Block denominators;
+  // the scaled DC coefficient is added to all 64 samples
+  double shift = get_level_shift();
+
+  make_inverse_table(table);
+  make_inverse_fractions(numerators, denominators);
+
+  for(Matrix<double> &plane : *mat_pic_) {
+    plane.advise(0, height, MappedFile::SEQUENTIAL);
+
+    ThreadPool::get_default().parallel_for((height + 7) / 8, 1,
+        [&](unsigned int begin, unsigned int end) {
+          Block mat_buffer;
+
+          for(unsigned int i = begin * 8; i < end * 8; i += 8) {
+            for(unsigned int j = 0; j < width; j += 8) {
+              load_block(plane, i, j, mat_buffer);
 
-      inv_quantisation(mat_buffer, *quantization_, quality_); 
+              if(method_ == ISLOW) {
+                inverse_islow(mat_buffer, numerators, denominators);
+              } else {
+                scale(mat_buffer, table); 
 
-      mat_buffer = trans * mat_buffer * trans.transpose();
+                mat_buffer(0, 0) += shift;
 
-      mat_buffer = mat_buffer + 128;
+                DCTKernel::inverse(mat_buffer.get_row(0));
 
-      round(mat_buffer);
+                round(mat_buffer);
+              }
 
-      for(unsigned int k = i, k_end = i + 8; k < k_end; ++k) {
-        for(unsigned int l = j, l_end = j + 8; l < l_end; ++l) {
-          if(k < height && l < width) { 
-            mat_pic_->set_data(k, l, mat_buffer.get_data(k - i, l - j));
+              store_block(plane, i, j, mat_buffer);
+            }
+            // a file backed plane only keeps the stripes in work resident
+            plane.advise(i, i + 8, MappedFile::DONT_NEED);
           }
-        }
-      }
-    }
+        });
   }
-
 }
 
 void DCT::set_quality(const unsigned char &quality) {
@@ -141,100 +207,299 @@ void DCT::set_color_depth(const unsigned int &color_depth) {
 unsigned int DCT::get_color_depth() const {
   return color_depth_;
 } 
+
+// the value the samples are centered around before the transformation - 128
+// for 8 bit pictures, half of the range for pictures with a higher bit depth
+unsigned int DCT::get_level_shift() const {
+  return (color_depth_ > 255) ? (color_depth_ + 1) / 2 : 128;
+}
+
+void DCT::set_method(const Method &method) {
+  method_ = method;
+}
+
+DCT::Method DCT::get_method() const {
+  return method_;
+}
  
-Matrix<Pixel<double> > DCT::get_mat_pic() const {
+const Image<double> &DCT::get_mat_pic() const {
   return *mat_pic_; 
 }
 
+// hands the image matrix over to the caller, the DCT is left without one
+Image<double> DCT::release_mat_pic() {
+  Image<double> mat_pic = std::move(*mat_pic_);
+
+  delete mat_pic_;
+  mat_pic_ = NULL;
+  return mat_pic;
+}
+
+// takes over the image matrix without copying it
+void DCT::set_mat_pic(Image<double> &&mat_pic) {
+  if(mat_pic_ == NULL) {
+    mat_pic_ = new Image<double>(std::move(mat_pic));
+  } else {
+    *mat_pic_ = std::move(mat_pic);
+  }
+}
+
 void DCT::set_quantization(const Matrix<unsigned char> &quantization) {
   delete quantization_;
   quantization_ = new Matrix<unsigned char> (quantization);
 }
 
-Matrix<unsigned char> DCT::get_quantization() const { 
+const Matrix<unsigned char> &DCT::get_quantization() const { 
   return *quantization_;  
 }  
 
-DCT DCT::operator=(const DCT &copy) {
+DCT &DCT::operator=(const DCT &copy) {
   if(this != &copy) {
-    Matrix<double> *del_1;
-    quality_ = copy.get_quality();
+    quality_ = copy.quality_;
+    method_ = copy.method_;
     color_depth_ = copy.get_color_depth();
-    del_1 = transformation_;
-    transformation_ = new Matrix<double>(8);
-    delete del_1;
-    Matrix<unsigned char> *del_2 = quantization_;
-    quantization_ = new Matrix<unsigned char>(copy.get_quantization());  
-    delete del_2; 
-    Matrix<Pixel<double> > *del_3 = mat_pic_;
-    mat_pic_ = new Matrix<Pixel<double> >(copy.get_mat_pic());
-    delete del_3;
-
-    make_transformation_matrix();
+
+    // this or copy may have been moved from
+    if(copy.quantization_ == NULL) {
+      delete quantization_;
+      quantization_ = NULL;
+    } else if(quantization_ == NULL) {
+      quantization_ = new Matrix<unsigned char>(copy.get_quantization());
+    } else {
+      *quantization_ = copy.get_quantization();
+    }
+
+    if(copy.mat_pic_ == NULL) {
+      delete mat_pic_;
+      mat_pic_ = NULL;
+    } else {
+      set_mat_pic(Image<double>(copy.get_mat_pic()));
+    }
   }
   return *this;
 }
 
-// rounds the subpixels of the image matrix
-void DCT::round(Matrix<Pixel<double> > &mat) {
-  Pixel<double> pixel;
-  double buffer;
+DCT &DCT::operator=(DCT &&rhs) {
+  if(this != &rhs) {
+    quality_ = rhs.quality_;
+    method_ = rhs.method_;
+    color_depth_ = rhs.color_depth_;
+    std::swap(mat_pic_, rhs.mat_pic_);
+    std::swap(quantization_, rhs.quantization_);
+  }
+  return *this;
+}
+
+// rounds the cells of the block - halfway cases to even. The kernels hit
+// exact halves, e.g. on flat blocks, and rounding them all away from zero
+// decodes those blocks one too high. Adding 1.5 * 2^52 pushes the fraction
+// out of the double, so the addition rounds like rint() for cells below 2^51
+void DCT::round(Block &block) {
+  const double bias = 6755399441055744.0;
+  double *cells = block.get_row(0);
+
+  for(unsigned int k = 0; k < 64; ++k) {
+    cells[k] = (cells[k] + bias) - bias;
+  }
+}
 
-  for(unsigned int i = 0; i < mat.get_row_length(); ++i) {
-    for(unsigned int j = 0; j < mat.get_col_length(); ++j) {
-      pixel = mat.get_data(i, j);
+// copies the 8x8 block at row, col of the plane in to block - the cells
+// outside of the plane are 0
+void DCT::load_block(const Matrix<double> &plane,
+                     const unsigned int &row,
+                     const unsigned int &col,
+                     Block &block) {
+  if(row + 8 > plane.get_row_length() || col + 8 > plane.get_col_length()) {
+    block = plane.get_view(row, col, 8, 8);
+    return;
+  }
 
-      for(unsigned int k = 0; k < pixel.size(); ++k) {
-        buffer = pixel.get_pixel(k);
+  for(unsigned int i = 0; i < 8; ++i) {
+    const double *src = plane.get_row(row + i) + col;
+    double *dst = block.get_row(i);
 
-        if(buffer > 0) {
-          buffer = buffer + 0.5;
-        } else {
-          buffer = buffer - 0.5;
-        }
-        pixel.set_pixel(k, (int)buffer);
-      }
-      mat.set_data(i, j,  pixel);
+    for(unsigned int j = 0; j < 8; ++j) {
+      dst[j] = src[j];
     }
-  } 
+  }
 }
-void DCT::quantisation(Matrix<Pixel<double> > &pic_mat,
-                  const Matrix<unsigned char> &quantization,
-                  const double &quality) {
-  Pixel<double> buffer;
 
-  for(unsigned int i = 0; i < pic_mat.get_row_length(); ++i) {
-    for(unsigned int j = 0; j < pic_mat.get_col_length(); ++j) {
-      buffer = pic_mat.get_data(i, j) * quality / quantization.get_data(i, j);
-      pic_mat.set_data(i, j, buffer);
+// copies the cells of block that lie inside of the plane back to row, col
+void DCT::store_block(Matrix<double> &plane,
+                      const unsigned int &row,
+                      const unsigned int &col,
+                      const Block &block) {
+  if(row + 8 > plane.get_row_length() || col + 8 > plane.get_col_length()) {
+    BlockView view = plane.get_view(row, col, 8, 8);
+
+    view = block;
+    return;
+  }
+
+  for(unsigned int i = 0; i < 8; ++i) {
+    const double *src = block.get_row(i);
+    double *dst = plane.get_row(row + i) + col;
+
+    for(unsigned int j = 0; j < 8; ++j) {
+      dst[j] = src[j];
     }
   }
 }
 
-void  DCT::inv_quantisation(Matrix<Pixel<double> > &pic_mat,
-                      const Matrix<unsigned char> &quantization,
-                      const double &quality) {
-  Pixel<double> buffer;
+// multiplies every cell of the block with the cell of factors
+void DCT::scale(Block &block, const Block &factors) {
+  double *cells = block.get_row(0);
+  const double *factor = factors.get_row(0);
+
+  for(unsigned int k = 0; k < 64; ++k) {
+    cells[k] *= factor[k];
+  }
+}
 
-  for(unsigned int i = 0; i < pic_mat.get_row_length(); ++i) {
-    for(unsigned int j = 0; j < pic_mat.get_col_length(); ++j) {
-      buffer = pic_mat.get_data(i, j) / quality * quantization.get_data(i, j);
-      pic_mat.set_data(i, j, buffer);
+// the factors from the outputs of DCTKernel::forward to the quantised
+// coefficients - quality / (quantisation * 8 * the scales of the kernel)
+void DCT::make_forward_table(Block &table) const {
+  for(unsigned int i = 0; i < 8; ++i) {
+    for(unsigned int j = 0; j < 8; ++j) {
+      table(i, j) = quality_ / (quantization_->get_data(i, j) * 8
+                                * DCTKernel::get_scale(i)
+                                * DCTKernel::get_scale(j));
     }
   }
-} 
+}
+
+// the factors from the quantised coefficients to the inputs of
+// DCTKernel::inverse - the division of its outputs by 8 is folded in, too
+void DCT::make_inverse_table(Block &table) const {
+  for(unsigned int i = 0; i < 8; ++i) {
+    for(unsigned int j = 0; j < 8; ++j) {
+      table(i, j) = quantization_->get_data(i, j) / quality_
+                    * DCTKernel::get_scale(i) * DCTKernel::get_scale(j) / 8;
+    }
+  }
+}
 
-void  DCT::make_transformation_matrix() {
-  double first_row = 1 / (2 * sqrt(2));
+// the fractions the outputs of DCTKernel::forward_islow are multiplied with to
+// quantise them - quality / (quantisation * 8) with the quality in percent
+void DCT::make_forward_fractions(Block &numerators,
+                                 Block &denominators) const {
+  double percent = floor(quality_ * 50 + 0.5);
 
   for(unsigned int i = 0; i < 8; ++i) {
-    transformation_->set_data(i, 0, first_row);
+    for(unsigned int j = 0; j < 8; ++j) {
+      // a cell of 0 is taken as 1
+      int quantization = std::max<int>(quantization_->get_data(i, j), 1);
+
+      numerators(i, j) = percent;
+      denominators(i, j) = quantization * 8 * 50;
+    }
+  }
+}
+
+// the fractions the quantised coefficients are multiplied with to get the
+// inputs of DCTKernel::inverse_islow - quantisation / quality
+void DCT::make_inverse_fractions(Block &numerators,
+                                 Block &denominators) const {
+  double percent = floor(quality_ * 50 + 0.5);
 
-    for(int j = 1; j < 8; ++j) {
-      transformation_->set_data(i, j, 0.5 * cos((2 * i + 1) * j 
-                                      * ::pi() / 16)); 
+  for(unsigned int i = 0; i < 8; ++i) {
+    for(unsigned int j = 0; j < 8; ++j) {
+      // a quality of 0 keeps no coefficient
+      numerators(i, j) = (percent == 0) ? 0
+                         : quantization_->get_data(i, j) * 50;
+      denominators(i, j) = (percent == 0) ? 1 : percent;
     }
-  } 
+  }
+}
+
+// transforms and quantises the block with the integer kernels. The 32 bit
+// kernels only take blocks whose samples are at most FORWARD_INT_LIMIT away
+// from the level shift, the others go through the 64 bit kernel - both give
+// the same integers, so the coefficients only depend on the samples
+void DCT::forward_islow(Block &block,
+                        const Block &numerators,
+                        const Block &denominators) const {
+  double *values = block.get_row(0);
+  double shift = get_level_shift();
+  double largest = 0;
+
+  for(unsigned int k = 0; k < 64; ++k) {
+    values[k] = std::min(std::max(values[k] - shift, -FORWARD_WIDE_LIMIT),
+                         FORWARD_WIDE_LIMIT);
+    largest = std::max(largest, fabs(values[k]));
+  }
+
+  if(largest <= FORWARD_INT_LIMIT) {
+    forward_islow_cells<int>(block, numerators, denominators);
+  } else {
+    forward_islow_cells<long long>(block, numerators, denominators);
+  }
+}
+
+// dequantises the coefficients of the block and transforms them back with the
+// integer kernels - the kernel is chosen like in forward_islow
+void DCT::inverse_islow(Block &block,
+                        const Block &numerators,
+                        const Block &denominators) const {
+  double *values = block.get_row(0);
+  const double *numerator = numerators.get_row(0);
+  const double *denominator = denominators.get_row(0);
+  double largest = 0;
+
+  for(unsigned int k = 0; k < 64; ++k) {
+    values[k] = std::min(std::max(divide<long long>(values[k] * numerator[k],
+                                                    denominator[k]),
+                                  -INVERSE_WIDE_LIMIT),
+                         INVERSE_WIDE_LIMIT);
+    largest = std::max(largest, fabs(values[k]));
+  }
+
+  if(largest <= INVERSE_INT_LIMIT) {
+    inverse_islow_cells<int>(block);
+  } else {
+    inverse_islow_cells<long long>(block);
+  }
+}
+
+// transforms the centered samples of the block with integers of type T and
+// quantises the coefficients
+template <typename T>
+void DCT::forward_islow_cells(Block &block,
+                              const Block &numerators,
+                              const Block &denominators) const {
+  T cells[64];
+  double *values = block.get_row(0);
+  const double *numerator = numerators.get_row(0);
+  const double *denominator = denominators.get_row(0);
+
+  for(unsigned int k = 0; k < 64; ++k) {
+    cells[k] = (T)values[k];
+  }
+
+  DCTKernel::forward_islow(cells);
+
+  for(unsigned int k = 0; k < 64; ++k) {
+    values[k] = divide<T>(cells[k] * numerator[k], denominator[k]);
+  }
+}
+
+// transforms the dequantised coefficients of the block back with integers of
+// type T
+template <typename T>
+void DCT::inverse_islow_cells(Block &block) const {
+  T cells[64];
+  double *values = block.get_row(0);
+  T shift = get_level_shift();
+
+  for(unsigned int k = 0; k < 64; ++k) {
+    cells[k] = (T)values[k];
+  }
+
+  DCTKernel::inverse_islow(cells);
+
+  for(unsigned int k = 0; k < 64; ++k) {
+    values[k] = cells[k] + shift;
+  }
 }
 
 void DCT::create_default_quantisation() {
@@ -2,21 +2,25 @@
 #define DCT_HPP 
 
 #include "Matrix.hpp"
-#include "Pixel.hpp"
-
-namespace {
-  double pi() { 
-    return 3.14159265358979;
-  }
-}
+#include "FixedMatrix.hpp"
+#include "Image.hpp"
 
 // The class provides the ability to use the Discrete Cousinus transformation an
-// an image matrix
+// an image matrix - the blocks are transformed by the separable fast DCT of
+// DCTKernel, its scaling is folded in to the quantisation. The stripes of 8
+// rows are transformed in parallel by the default ThreadPool
 class DCT {
 public:
+  // the arithmetic of the transformation - FLOAT transforms in double
+  // precision, ISLOW with the integer kernels of DCTKernel, which code a
+  // picture bit for bit the same on every machine
+  enum Method { FLOAT, ISLOW };
+
   DCT();
-  DCT(const Matrix<Pixel<double> > &data, const unsigned int &color_depth);
+  DCT(const Image<double> &data, const unsigned int &color_depth);
+  DCT(Image<double> &&data, const unsigned int &color_depth);
   DCT(const DCT &copy);
+  DCT(DCT &&other);
   ~DCT();
   void forward_dct();
   void inverse_dct();
@@ -24,27 +28,54 @@ public:
   unsigned char get_quality() const;   
   void set_color_depth(const unsigned int &color_depth);
   unsigned int get_color_depth() const;
-  Matrix<Pixel<double> > get_mat_pic() const;
+  unsigned int get_level_shift() const;
+  void set_method(const Method &method);
+  Method get_method() const;
+  const Image<double> &get_mat_pic() const;
+  Image<double> release_mat_pic();
+  void set_mat_pic(Image<double> &&mat_pic);
   void set_quantization(const Matrix<unsigned char> &quantization);
-  Matrix<unsigned char> get_quantization() const;
-  DCT operator=(const DCT &copy);
+  const Matrix<unsigned char> &get_quantization() const;
+  DCT &operator=(const DCT &copy);
+  DCT &operator=(DCT &&rhs);
 
 protected:
-  void round(Matrix<Pixel<double> > &mat);
-  void quantisation(Matrix<Pixel<double> > &pic_mat,
-                    const Matrix<unsigned char> &quantization,
-                    const double &quality);
-  void inv_quantisation(Matrix<Pixel<double> > &pic_mat,
-                        const Matrix<unsigned char> &quantization,
-                        const double &quality);
-  void make_transformation_matrix();
+  typedef FixedMatrix<double, 8, 8> Block;
+  typedef MatrixView<double> BlockView;
+
+  void round(Block &block);
+  void load_block(const Matrix<double> &plane,
+                  const unsigned int &row,
+                  const unsigned int &col,
+                  Block &block);
+  void store_block(Matrix<double> &plane,
+                   const unsigned int &row,
+                   const unsigned int &col,
+                   const Block &block);
+  void scale(Block &block, const Block &factors);
+  void make_forward_table(Block &table) const;
+  void make_inverse_table(Block &table) const;
+  void make_forward_fractions(Block &numerators, Block &denominators) const;
+  void make_inverse_fractions(Block &numerators, Block &denominators) const;
+  void forward_islow(Block &block,
+                     const Block &numerators,
+                     const Block &denominators) const;
+  void inverse_islow(Block &block,
+                     const Block &numerators,
+                     const Block &denominators) const;
+  template <typename T>
+  void forward_islow_cells(Block &block,
+                           const Block &numerators,
+                           const Block &denominators) const;
+  template <typename T>
+  void inverse_islow_cells(Block &block) const;
   void create_default_quantisation();
 
 
   double quality_;
   unsigned int color_depth_;
-  Matrix<Pixel<double> > *mat_pic_;
-  Matrix<double> *transformation_;
+  Method method_;
+  Image<double> *mat_pic_;
   Matrix<unsigned char> *quantization_;
 };
 
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <utility>
 
 #include "DCTFile.hpp"
 #include "Huffile.hpp"
@@ -9,7 +10,13 @@ DCTFile::DCTFile() : DCT() {
 }
 
 // Constructor for a image matrix and a color depth
-DCTFile::DCTFile(const Matrix<Pixel<double> > &data, const unsigned int &color_depth): DCT(data, color_depth) {
+DCTFile::DCTFile(const Image<double> &data, const unsigned int &color_depth): DCT(data, color_depth) {
+  file_size_ = 0; 
+}
+
+// Constructor that takes over a image matrix and a color depth
+DCTFile::DCTFile(Image<double> &&data, const unsigned int &color_depth)
+    : DCT(std::move(data), color_depth) {
   file_size_ = 0; 
 }
 
@@ -31,11 +38,17 @@ DCTFile::~DCTFile() {
 //makes a string of the File - not readable for the human
 std::string DCTFile::to_string() {
   std::ostringstream ss;
-  unsigned char subpixels = mat_pic_->get_data(0,0).size();
+  unsigned char subpixels = mat_pic_->get_channels();
 
-  ss << "Humdi"
-  << super::get_quality()
-  << subpixels << get_color_depth() << ' '
+  // the floating point files keep the header of the first version, a file of
+  // an other method has its own magic and a byte for the method
+  if(super::get_method() == DCT::FLOAT) {
+    ss << "Humdi" << super::get_quality();
+  } else {
+    ss << "Humdm" << super::get_quality()
+    << (unsigned char)super::get_method();
+  }
+  ss << subpixels << get_color_depth() << ' '
   << mat_pic_->get_row_length() << ' ' << mat_pic_->get_col_length() << ' ';
   
   for(unsigned int i = 0, i_end = quantization_->get_row_length();
@@ -47,14 +60,14 @@ std::string DCTFile::to_string() {
   }
 
   //TODO replace with real ZigZag
-  signed char last_data = 0;
-  signed char next_data = 0; 
+  bool wide = has_wide_coefficients();
+  int last_data = 0;
+  int next_data = 0; 
   unsigned char data_count = 0;
   unsigned int row_pos = 0;
   unsigned int row_length = mat_pic_->get_row_length();
   unsigned int col_pos = 0;
   unsigned int col_length = mat_pic_->get_col_length();
-  Pixel<double> pixel;
   
   for(unsigned int i = 0; i < row_length; i += 8) {
     for(unsigned int j = 0; j < col_length; j += 8) {
@@ -64,16 +77,16 @@ std::string DCTFile::to_string() {
           col_pos = j + l;
 
           if(row_pos < row_length && col_pos < col_length) { 
-            pixel = mat_pic_->get_data(row_pos, col_pos);
-
             for(unsigned char m = 0; m < subpixels; ++m) {
-              next_data = pixel.get_pixel(m);
+              next_data = get_coefficient((*mat_pic_)(row_pos, col_pos, m),
+                                          wide);
 
               if(next_data == last_data && data_count < 255) {
                 ++data_count;
               } else {
                 if(data_count != 0) {
-                  ss << data_count << last_data;
+                  ss << data_count;
+                  put_coefficient(ss, last_data, wide);
                 }
                 data_count = 1;
                 last_data = next_data;
@@ -88,16 +101,16 @@ std::string DCTFile::to_string() {
           col_pos = j + l + k;
 
           if(row_pos < row_length && col_pos < col_length) { 
-            pixel = mat_pic_->get_data(row_pos, col_pos);
-
             for(unsigned char m = 0; m < subpixels; ++m) {
-              next_data = pixel.get_pixel(m);
+              next_data = get_coefficient((*mat_pic_)(row_pos, col_pos, m),
+                                          wide);
 
               if(next_data == last_data && data_count < 255) {
                 ++data_count;
               } else {
                 if(data_count != 0) {
-                  ss << data_count << last_data;
+                  ss << data_count;
+                  put_coefficient(ss, last_data, wide);
                 }
                 data_count = 1;
                 last_data = next_data;
@@ -109,7 +122,8 @@ std::string DCTFile::to_string() {
     }
   } 
   if(data_count != 0) {
-    ss << data_count << last_data;
+    ss << data_count;
+    put_coefficient(ss, last_data, wide);
     data_count = 0;
     last_data = next_data;
   }
@@ -119,11 +133,8 @@ std::string DCTFile::to_string() {
 // writes the encoded file to the location
 void DCTFile::write_to(const std::string &filename = "Humdidum.humdi") {
   std::string buffer = to_string();
-  std::vector<unsigned char> *vec = new std::vector<unsigned char>();
-  
-  for(unsigned int i = 0; i < buffer.size(); ++i) {
-    vec->push_back(buffer.at(i));
-  }
+  std::vector<unsigned char> *vec = new std::vector<unsigned char>(
+      buffer.begin(), buffer.end());
   
   Huffile *h = new Huffile();
   h->set_data(*vec); 
@@ -143,11 +154,30 @@ void DCTFile::parse(const std::string &s) {
   unsigned int pos = 5;
   std::ostringstream ss;
 
-  if(s.compare(0, pos, "Humdi") != 0) {
+  bool has_method = s.compare(0, pos, "Humdm") == 0;
+
+  if(!has_method && s.compare(0, pos, "Humdi") != 0) {
     throw DCTFileExce::BadHeader("In DCTFile::parse");
   }  
   super::set_quality(s.at(pos));
   ++pos;
+
+  // a file without a method byte was transformed with doubles
+  super::set_method(DCT::FLOAT);
+
+  if(has_method) {
+    switch(s.at(pos)) {
+      case DCT::FLOAT:
+        break;
+      case DCT::ISLOW:
+        super::set_method(DCT::ISLOW);
+        break;
+      default:
+        throw DCTFileExce::BadHeader(
+            "Unknown transform method in DCTFile::parse");
+    }
+    ++pos;
+  }
   subpixels = s.at(pos);
   ++pos;
 
@@ -191,14 +221,14 @@ void DCTFile::parse(const std::string &s) {
   }  
 
   delete mat_pic_;
-  mat_pic_ = new Matrix<Pixel<double> >(rows, cols);
+  mat_pic_ = new Image<double>(rows, cols, subpixels);
 
 
-  signed char data = 0;
+  bool wide = has_wide_coefficients();
+  int data = 0;
   unsigned char data_count = 0;
   unsigned int row_pos = 0;
   unsigned int col_pos = 0;
-  Pixel<double> p = Pixel<double>(subpixels);
 
   for(unsigned int i = 0; i < rows; i += 8) {
     for(unsigned int j = 0; j < cols; j += 8) {
@@ -211,12 +241,11 @@ void DCTFile::parse(const std::string &s) {
             for(unsigned char m = 0; m < subpixels; ++m) {
               if(data_count == 0) {
                 data_count = s.at(pos++);
-                data = s.at(pos++);
+                data = parse_coefficient(s, pos, wide);
               }
-              p.set_pixel(m, data);
+              (*mat_pic_)(row_pos, col_pos, m) = data;
               --data_count;
             }
-            mat_pic_->set_data(row_pos, col_pos, p);
           }
         }
       }
@@ -229,12 +258,11 @@ void DCTFile::parse(const std::string &s) {
             for(unsigned char m = 0; m < subpixels; ++m) {
               if(data_count == 0) {
                 data_count = s.at(pos++);
-                data = s.at(pos++);
+                data = parse_coefficient(s, pos, wide);
               }
-              p.set_pixel(m, data);
+              (*mat_pic_)(row_pos, col_pos, m) = data;
               --data_count;
             }
-            mat_pic_->set_data(row_pos, col_pos, p);
           }
         }
       }
@@ -242,6 +270,50 @@ void DCTFile::parse(const std::string &s) {
   } 
 }
 
+// pictures with more than 8 bit per subpixel keep their coefficients in 32
+// bit, the others in a signed char
+bool DCTFile::has_wide_coefficients() const {
+  return get_color_depth() > 255;
+}
+
+// cuts the transformed value to the width of a coefficient
+int DCTFile::get_coefficient(const double &value, const bool &wide) {
+  if(wide) {
+    return (int)value;
+  }
+  return (signed char)value;
+}
+
+// appends a coefficient - a wide one with the most significant byte first
+void DCTFile::put_coefficient(std::ostringstream &ss,
+                              const int &coefficient,
+                              const bool &wide) {
+  if(!wide) {
+    ss << (signed char)coefficient;
+    return;
+  }
+  unsigned int bits = coefficient;
+
+  for(int shift = 24; shift >= 0; shift -= 8) {
+    ss << (unsigned char)(bits >> shift);
+  }
+}
+
+// reads a coefficient written by put_coefficient
+int DCTFile::parse_coefficient(const std::string &s,
+                               unsigned int &pos,
+                               const bool &wide) {
+  if(!wide) {
+    return (signed char)s.at(pos++);
+  }
+  unsigned int bits = 0;
+
+  for(int k = 0; k < 4; ++k) {
+    bits = (bits << 8) | (unsigned char)s.at(pos++);
+  }
+  return (int)bits;
+}
+
 /**
  * @return the return value is the file size of the encoded file
  */
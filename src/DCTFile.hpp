@@ -82,7 +82,8 @@ public:
 
   DCTFile();
   DCTFile(const std::string &filename);
-  DCTFile(const Matrix<Pixel<double> > &data, const unsigned int &color_depth);
+  DCTFile(const Image<double> &data, const unsigned int &color_depth);
+  DCTFile(Image<double> &&data, const unsigned int &color_depth);
   ~DCTFile();
 
   std::string to_string();
@@ -91,6 +92,14 @@ public:
 
 private:
   void parse(const std::string &s);
+  bool has_wide_coefficients() const;
+  static int get_coefficient(const double &value, const bool &wide);
+  static void put_coefficient(std::ostringstream &ss,
+                              const int &coefficient,
+                              const bool &wide);
+  static int parse_coefficient(const std::string &s,
+                               unsigned int &pos,
+                               const bool &wide);
   unsigned int color_depth_;
   double file_size_;
 };
@@ -0,0 +1,634 @@
+#include <math.h>
+#include <string.h>
+
+#include "DCTKernel.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DCT_KERNEL_X86
+#endif
+
+// the butterflies are inlined in to the kernels of every instruction set
+#define DCT_INLINE inline __attribute__((always_inline))
+
+// the loops over the vectors of a block are unrolled, so the block stays in
+// registers, and multiplications are not fused with additions, so every
+// kernel rounds like the scalar one
+#define DCT_KERNEL __attribute__((optimize("peel-loops", "fp-contract=off")))
+
+namespace {
+  enum Isa { GENERIC, SSE41, AVX2, AVX512 };
+
+  // asks the cpu once which kernel can be used
+  Isa get_isa() {
+    static const Isa isa = []() {
+#ifdef DCT_KERNEL_X86
+      __builtin_cpu_init();
+      if(__builtin_cpu_supports("avx512f")) {
+        return AVX512;
+      }
+      if(__builtin_cpu_supports("avx2")) {
+        return AVX2;
+      }
+      if(__builtin_cpu_supports("sse4.1")) {
+        return SSE41;
+      }
+#endif
+      return GENERIC;
+    }();
+    return isa;
+  }
+
+  // 4 and 8 doubles or ints - the operations of the vector extensions of gcc
+  // are the ones of the scalars, lane by lane
+  typedef double Vec4 __attribute__((vector_size(32)));
+  typedef double Vec8 __attribute__((vector_size(64)));
+  typedef long long Mask4 __attribute__((vector_size(32)));
+  typedef long long Mask8 __attribute__((vector_size(64)));
+  typedef int IntVec4 __attribute__((vector_size(16)));
+  typedef int IntVec8 __attribute__((vector_size(32)));
+
+  // the DCT of the 8 points d[0], d[stride], ... d[7 * stride] - the points
+  // are doubles or vectors of the points of neighbouring columns
+  template <typename T>
+  DCT_INLINE void forward_points(T *d, const unsigned int &stride) {
+    T tmp0 = d[0] + d[7 * stride];
+    T tmp7 = d[0] - d[7 * stride];
+    T tmp1 = d[stride] + d[6 * stride];
+    T tmp6 = d[stride] - d[6 * stride];
+    T tmp2 = d[2 * stride] + d[5 * stride];
+    T tmp5 = d[2 * stride] - d[5 * stride];
+    T tmp3 = d[3 * stride] + d[4 * stride];
+    T tmp4 = d[3 * stride] - d[4 * stride];
+
+    // even part
+    T tmp10 = tmp0 + tmp3;
+    T tmp13 = tmp0 - tmp3;
+    T tmp11 = tmp1 + tmp2;
+    T tmp12 = tmp1 - tmp2;
+    T z1 = (tmp12 + tmp13) * 0.707106781186547524;
+
+    d[0] = tmp10 + tmp11;
+    d[4 * stride] = tmp10 - tmp11;
+    d[2 * stride] = tmp13 + z1;
+    d[6 * stride] = tmp13 - z1;
+
+    // odd part
+    tmp10 = tmp4 + tmp5;
+    tmp11 = tmp5 + tmp6;
+    tmp12 = tmp6 + tmp7;
+
+    T z5 = (tmp10 - tmp12) * 0.382683432365089772;
+    T z2 = 0.541196100146196984 * tmp10 + z5;
+    T z4 = 1.306562964876376528 * tmp12 + z5;
+    T z3 = tmp11 * 0.707106781186547524;
+    T z11 = tmp7 + z3;
+    T z13 = tmp7 - z3;
+
+    d[5 * stride] = z13 + z2;
+    d[3 * stride] = z13 - z2;
+    d[stride] = z11 + z4;
+    d[7 * stride] = z11 - z4;
+  }
+
+  // the inverse DCT of the 8 points d[0], d[stride], ... d[7 * stride]
+  template <typename T>
+  DCT_INLINE void inverse_points(T *d, const unsigned int &stride) {
+    // even part
+    T tmp10 = d[0] + d[4 * stride];
+    T tmp11 = d[0] - d[4 * stride];
+    T tmp13 = d[2 * stride] + d[6 * stride];
+    T tmp12 = (d[2 * stride] - d[6 * stride]) * 1.414213562373095049
+                   - tmp13;
+    T tmp0 = tmp10 + tmp13;
+    T tmp3 = tmp10 - tmp13;
+    T tmp1 = tmp11 + tmp12;
+    T tmp2 = tmp11 - tmp12;
+
+    // odd part
+    T z13 = d[5 * stride] + d[3 * stride];
+    T z10 = d[5 * stride] - d[3 * stride];
+    T z11 = d[stride] + d[7 * stride];
+    T z12 = d[stride] - d[7 * stride];
+    T tmp7 = z11 + z13;
+
+    tmp11 = (z11 - z13) * 1.414213562373095049;
+
+    T z5 = (z10 + z12) * 1.847759065022573512;
+
+    tmp10 = 1.082392200292393968 * z12 - z5;
+    tmp12 = -2.613125929752753055 * z10 + z5;
+
+    T tmp6 = tmp12 - tmp7;
+    T tmp5 = tmp11 - tmp6;
+    T tmp4 = tmp10 + tmp5;
+
+    d[0] = tmp0 + tmp7;
+    d[7 * stride] = tmp0 - tmp7;
+    d[stride] = tmp1 + tmp6;
+    d[6 * stride] = tmp1 - tmp6;
+    d[2 * stride] = tmp2 + tmp5;
+    d[5 * stride] = tmp2 - tmp5;
+    d[4 * stride] = tmp3 + tmp4;
+    d[3 * stride] = tmp3 - tmp4;
+  }
+
+  // transposes the 4x4 tile of the rows v[0], v[stride], ... v[3 * stride] -
+  // M is the mask type of V
+  template <typename V, typename M>
+  DCT_INLINE void transpose4(V *v, const unsigned int &stride) {
+    V a0 = __builtin_shuffle(v[0], v[stride], M{0, 4, 2, 6});
+    V a1 = __builtin_shuffle(v[0], v[stride], M{1, 5, 3, 7});
+    V a2 = __builtin_shuffle(v[2 * stride], v[3 * stride], M{0, 4, 2, 6});
+    V a3 = __builtin_shuffle(v[2 * stride], v[3 * stride], M{1, 5, 3, 7});
+
+    v[0] = __builtin_shuffle(a0, a2, M{0, 1, 4, 5});
+    v[stride] = __builtin_shuffle(a1, a3, M{0, 1, 4, 5});
+    v[2 * stride] = __builtin_shuffle(a0, a2, M{2, 3, 6, 7});
+    v[3 * stride] = __builtin_shuffle(a1, a3, M{2, 3, 6, 7});
+  }
+
+  // transposes the 8x8 tile of the rows v[0], v[stride], ... v[7 * stride] -
+  // pairs of cells, then pairs of pairs and then halves are interleaved
+  template <typename V, typename M>
+  DCT_INLINE void transpose8(V *v, const unsigned int &stride) {
+    V a[8];
+    V b[8];
+
+    for(unsigned int k = 0; k < 8; k += 2) {
+      a[k] = __builtin_shuffle(v[k * stride], v[(k + 1) * stride],
+                               M{0, 8, 2, 10, 4, 12, 6, 14});
+      a[k + 1] = __builtin_shuffle(v[k * stride], v[(k + 1) * stride],
+                                   M{1, 9, 3, 11, 5, 13, 7, 15});
+    }
+    for(unsigned int k = 0; k < 8; ++k) {
+      if((k & 2) != 0) {
+        continue;
+      }
+      b[k] = __builtin_shuffle(a[k], a[k + 2], M{0, 1, 8, 9, 4, 5, 12, 13});
+      b[k + 2] = __builtin_shuffle(a[k], a[k + 2],
+                                   M{2, 3, 10, 11, 6, 7, 14, 15});
+    }
+    for(unsigned int k = 0; k < 4; ++k) {
+      v[k * stride] = __builtin_shuffle(b[k], b[k + 4],
+                                        M{0, 1, 2, 3, 8, 9, 10, 11});
+      v[(k + 4) * stride] = __builtin_shuffle(b[k], b[k + 4],
+                                              M{4, 5, 6, 7, 12, 13, 14, 15});
+    }
+  }
+
+  DCT_INLINE void transpose_tile(Vec4 *v, const unsigned int &stride) {
+    transpose4<Vec4, Mask4>(v, stride);
+  }
+
+  DCT_INLINE void transpose_tile(Vec8 *v, const unsigned int &stride) {
+    transpose8<Vec8, Mask8>(v, stride);
+  }
+
+  DCT_INLINE void transpose_tile(IntVec4 *v, const unsigned int &stride) {
+    transpose4<IntVec4, IntVec4>(v, stride);
+  }
+
+  DCT_INLINE void transpose_tile(IntVec8 *v, const unsigned int &stride) {
+    transpose8<IntVec8, IntVec8>(v, stride);
+  }
+
+  // transposes the block - v holds the rows, every row is 8 / lanes vectors
+  template <typename V>
+  DCT_INLINE void transpose(V *v) {
+    const unsigned int lanes = sizeof(V) / sizeof(v[0][0]);
+    const unsigned int width = 8 / lanes;
+
+    for(unsigned int a = 0; a < width; ++a) {
+      transpose_tile(v + a * lanes * width + a, width);
+
+      for(unsigned int b = a + 1; b < width; ++b) {
+        V *upper = v + a * lanes * width + b;
+        V *lower = v + b * lanes * width + a;
+
+        transpose_tile(upper, width);
+        transpose_tile(lower, width);
+
+        for(unsigned int k = 0; k < lanes; ++k) {
+          V tmp = upper[k * width];
+
+          upper[k * width] = lower[k * width];
+          lower[k * width] = tmp;
+        }
+      }
+    }
+  }
+
+  // copies the 64 cells of the block in to the vectors v, row after row
+  template <typename V, typename E>
+  DCT_INLINE void load(const E *block, V *v) {
+    for(unsigned int k = 0; k < 64 * sizeof(E) / sizeof(V); ++k) {
+      memcpy(v + k, block + k * sizeof(V) / sizeof(E), sizeof(V));
+    }
+  }
+
+  template <typename V, typename E>
+  DCT_INLINE void store(const V *v, E *block) {
+    for(unsigned int k = 0; k < 64 * sizeof(E) / sizeof(V); ++k) {
+      memcpy(block + k * sizeof(V) / sizeof(E), v + k, sizeof(V));
+    }
+  }
+
+  // the kernels for vectors of V - the columns are transformed as vectors of
+  // neighbouring columns, the rows as the columns of the transposed block
+  template <typename V>
+  DCT_INLINE void forward_lanes(double *block) {
+    const unsigned int width = 8 * sizeof(double) / sizeof(V);
+    V v[8 * width];
+
+    load(block, v);
+    transpose(v);
+
+    for(unsigned int p = 0; p < width; ++p) {
+      forward_points(v + p, width);
+    }
+    transpose(v);
+
+    for(unsigned int p = 0; p < width; ++p) {
+      forward_points(v + p, width);
+    }
+    store(v, block);
+  }
+
+  template <typename V>
+  DCT_INLINE void inverse_lanes(double *block) {
+    const unsigned int width = 8 * sizeof(double) / sizeof(V);
+    V v[8 * width];
+
+    load(block, v);
+
+    for(unsigned int p = 0; p < width; ++p) {
+      inverse_points(v + p, width);
+    }
+    transpose(v);
+
+    for(unsigned int p = 0; p < width; ++p) {
+      inverse_points(v + p, width);
+    }
+    transpose(v);
+    store(v, block);
+  }
+
+  DCT_KERNEL
+  void forward_generic(double *block) {
+    for(unsigned int i = 0; i < 8; ++i) {
+      forward_points(block + 8 * i, 1);
+    }
+    for(unsigned int j = 0; j < 8; ++j) {
+      forward_points(block + j, 8);
+    }
+  }
+
+  DCT_KERNEL
+  void inverse_generic(double *block) {
+    for(unsigned int j = 0; j < 8; ++j) {
+      inverse_points(block + j, 8);
+    }
+    for(unsigned int i = 0; i < 8; ++i) {
+      inverse_points(block + 8 * i, 1);
+    }
+  }
+
+  // the constants of the integer kernels - cos and sqrt terms in fixed point
+  // with 13 fraction bits, e.g. FIX_0_541196100 is 0.541196100 * 2^13
+  const int CONST_BITS = 13;
+  // the bits of fraction the first pass keeps for the second one
+  const int PASS1_BITS = 2;
+
+  const int FIX_0_298631336 = 2446;
+  const int FIX_0_390180644 = 3196;
+  const int FIX_0_541196100 = 4433;
+  const int FIX_0_765366865 = 6270;
+  const int FIX_0_899976223 = 7373;
+  const int FIX_1_175875602 = 9633;
+  const int FIX_1_501321110 = 12299;
+  const int FIX_1_847759065 = 15137;
+  const int FIX_1_961570560 = 16069;
+  const int FIX_2_053119869 = 16819;
+  const int FIX_2_562915447 = 20995;
+  const int FIX_3_072711026 = 25172;
+
+  // sets d to x / 2^n rounded to the nearest integer - gcc shifts negative
+  // numbers arithmetically, so this is the same on every machine
+  template <typename T>
+  DCT_INLINE void descale(T &d, const T &x, const int &n) {
+    d = (x + (1 << (n - 1))) >> n;
+  }
+
+  // the integer DCT of the 8 points d[0], d[stride], ... d[7 * stride] after
+  // Loeffler, Ligtenberg and Moschytz - the first pass scales its outputs by
+  // 2^PASS1_BITS, the second pass removes that scale again
+  template <typename T, bool FIRST>
+  DCT_INLINE void forward_islow_points(T *d, const unsigned int &stride) {
+    const int shift = FIRST ? CONST_BITS - PASS1_BITS
+                            : CONST_BITS + PASS1_BITS;
+    T tmp0 = d[0] + d[7 * stride];
+    T tmp7 = d[0] - d[7 * stride];
+    T tmp1 = d[stride] + d[6 * stride];
+    T tmp6 = d[stride] - d[6 * stride];
+    T tmp2 = d[2 * stride] + d[5 * stride];
+    T tmp5 = d[2 * stride] - d[5 * stride];
+    T tmp3 = d[3 * stride] + d[4 * stride];
+    T tmp4 = d[3 * stride] - d[4 * stride];
+
+    // even part
+    T tmp10 = tmp0 + tmp3;
+    T tmp13 = tmp0 - tmp3;
+    T tmp11 = tmp1 + tmp2;
+    T tmp12 = tmp1 - tmp2;
+
+    if(FIRST) {
+      d[0] = (tmp10 + tmp11) * (1 << PASS1_BITS);
+      d[4 * stride] = (tmp10 - tmp11) * (1 << PASS1_BITS);
+    } else {
+      descale(d[0], tmp10 + tmp11, PASS1_BITS);
+      descale(d[4 * stride], tmp10 - tmp11, PASS1_BITS);
+    }
+
+    T z1 = (tmp12 + tmp13) * FIX_0_541196100;
+
+    descale(d[2 * stride], z1 + tmp13 * FIX_0_765366865, shift);
+    descale(d[6 * stride], z1 - tmp12 * FIX_1_847759065, shift);
+
+    // odd part
+    z1 = tmp4 + tmp7;
+
+    T z2 = tmp5 + tmp6;
+    T z3 = tmp4 + tmp6;
+    T z4 = tmp5 + tmp7;
+    T z5 = (z3 + z4) * FIX_1_175875602;
+
+    tmp4 *= FIX_0_298631336;
+    tmp5 *= FIX_2_053119869;
+    tmp6 *= FIX_3_072711026;
+    tmp7 *= FIX_1_501321110;
+    z1 *= -FIX_0_899976223;
+    z2 *= -FIX_2_562915447;
+    z3 = z3 * -FIX_1_961570560 + z5;
+    z4 = z4 * -FIX_0_390180644 + z5;
+
+    descale(d[7 * stride], tmp4 + z1 + z3, shift);
+    descale(d[5 * stride], tmp5 + z2 + z4, shift);
+    descale(d[3 * stride], tmp6 + z2 + z3, shift);
+    descale(d[stride], tmp7 + z1 + z4, shift);
+  }
+
+  // the integer inverse DCT of the 8 points d[0], d[stride], ...
+  // d[7 * stride] - the outputs are divided by 2^shift
+  template <typename T>
+  DCT_INLINE void inverse_islow_points(T *d,
+                                       const unsigned int &stride,
+                                       const int &shift) {
+    // even part
+    T z1 = (d[2 * stride] + d[6 * stride]) * FIX_0_541196100;
+    T tmp2 = z1 - d[6 * stride] * FIX_1_847759065;
+    T tmp3 = z1 + d[2 * stride] * FIX_0_765366865;
+    T tmp0 = (d[0] + d[4 * stride]) * (1 << CONST_BITS);
+    T tmp1 = (d[0] - d[4 * stride]) * (1 << CONST_BITS);
+    T tmp10 = tmp0 + tmp3;
+    T tmp13 = tmp0 - tmp3;
+    T tmp11 = tmp1 + tmp2;
+    T tmp12 = tmp1 - tmp2;
+
+    // odd part
+    tmp0 = d[7 * stride];
+    tmp1 = d[5 * stride];
+    tmp2 = d[3 * stride];
+    tmp3 = d[stride];
+    z1 = tmp0 + tmp3;
+
+    T z2 = tmp1 + tmp2;
+    T z3 = tmp0 + tmp2;
+    T z4 = tmp1 + tmp3;
+    T z5 = (z3 + z4) * FIX_1_175875602;
+
+    tmp0 *= FIX_0_298631336;
+    tmp1 *= FIX_2_053119869;
+    tmp2 *= FIX_3_072711026;
+    tmp3 *= FIX_1_501321110;
+    z1 *= -FIX_0_899976223;
+    z2 *= -FIX_2_562915447;
+    z3 = z3 * -FIX_1_961570560 + z5;
+    z4 = z4 * -FIX_0_390180644 + z5;
+    tmp0 += z1 + z3;
+    tmp1 += z2 + z4;
+    tmp2 += z2 + z3;
+    tmp3 += z1 + z4;
+
+    descale(d[0], tmp10 + tmp3, shift);
+    descale(d[7 * stride], tmp10 - tmp3, shift);
+    descale(d[stride], tmp11 + tmp2, shift);
+    descale(d[6 * stride], tmp11 - tmp2, shift);
+    descale(d[2 * stride], tmp12 + tmp1, shift);
+    descale(d[5 * stride], tmp12 - tmp1, shift);
+    descale(d[3 * stride], tmp13 + tmp0, shift);
+    descale(d[4 * stride], tmp13 - tmp0, shift);
+  }
+
+  template <typename T>
+  DCT_INLINE void forward_islow_generic(T *block) {
+    for(unsigned int i = 0; i < 8; ++i) {
+      forward_islow_points<T, true>(block + 8 * i, 1);
+    }
+    for(unsigned int j = 0; j < 8; ++j) {
+      forward_islow_points<T, false>(block + j, 8);
+    }
+  }
+
+  // the columns keep PASS1_BITS of fraction, the rows drop them and divide
+  // by 8
+  template <typename T>
+  DCT_INLINE void inverse_islow_generic(T *block) {
+    for(unsigned int j = 0; j < 8; ++j) {
+      inverse_islow_points(block + j, 8, CONST_BITS - PASS1_BITS);
+    }
+    for(unsigned int i = 0; i < 8; ++i) {
+      inverse_islow_points(block + 8 * i, 1, CONST_BITS + PASS1_BITS + 3);
+    }
+  }
+
+  // the integer kernels for vectors of V like forward_lanes and inverse_lanes
+  template <typename V>
+  DCT_INLINE void forward_islow_lanes(int *block) {
+    const unsigned int width = 8 * sizeof(int) / sizeof(V);
+    V v[8 * width];
+
+    load(block, v);
+    transpose(v);
+
+    for(unsigned int p = 0; p < width; ++p) {
+      forward_islow_points<V, true>(v + p, width);
+    }
+    transpose(v);
+
+    for(unsigned int p = 0; p < width; ++p) {
+      forward_islow_points<V, false>(v + p, width);
+    }
+    store(v, block);
+  }
+
+  template <typename V>
+  DCT_INLINE void inverse_islow_lanes(int *block) {
+    const unsigned int width = 8 * sizeof(int) / sizeof(V);
+    V v[8 * width];
+
+    load(block, v);
+
+    for(unsigned int p = 0; p < width; ++p) {
+      inverse_islow_points(v + p, width, CONST_BITS - PASS1_BITS);
+    }
+    transpose(v);
+
+    for(unsigned int p = 0; p < width; ++p) {
+      inverse_islow_points(v + p, width, CONST_BITS + PASS1_BITS + 3);
+    }
+    transpose(v);
+    store(v, block);
+  }
+
+#ifdef DCT_KERNEL_X86
+  // the float kernels use all lanes of AVX-512, the integer ones the 8 lanes
+  // of 32 bits of AVX2 - SSE4.1 brings the multiplication of 32 bit lanes.
+  // Even 32 bit lanes only hold the intermediates for inputs up to 799
+  // (forward) and 1173 (inverse), so DCT hands bigger blocks to the 64 bit
+  // kernel; 16 bit lanes would overflow long before, e.g. a quantised 1 in a
+  // cell of 255 is 12750 at quality 1
+  __attribute__((target("avx2"))) DCT_KERNEL
+  void forward_avx2(double *block) {
+    forward_lanes<Vec4>(block);
+  }
+
+  __attribute__((target("avx2"))) DCT_KERNEL
+  void inverse_avx2(double *block) {
+    inverse_lanes<Vec4>(block);
+  }
+
+  __attribute__((target("avx512f"))) DCT_KERNEL
+  void forward_avx512(double *block) {
+    forward_lanes<Vec8>(block);
+  }
+
+  __attribute__((target("avx512f"))) DCT_KERNEL
+  void inverse_avx512(double *block) {
+    inverse_lanes<Vec8>(block);
+  }
+
+  __attribute__((target("sse4.1"))) DCT_KERNEL
+  void forward_islow_sse41(int *block) {
+    forward_islow_lanes<IntVec4>(block);
+  }
+
+  __attribute__((target("sse4.1"))) DCT_KERNEL
+  void inverse_islow_sse41(int *block) {
+    inverse_islow_lanes<IntVec4>(block);
+  }
+
+  __attribute__((target("avx2"))) DCT_KERNEL
+  void forward_islow_avx2(int *block) {
+    forward_islow_lanes<IntVec8>(block);
+  }
+
+  __attribute__((target("avx2"))) DCT_KERNEL
+  void inverse_islow_avx2(int *block) {
+    inverse_islow_lanes<IntVec8>(block);
+  }
+#endif
+}
+
+double DCTKernel::get_scale(const unsigned int &k) {
+  if(k == 0) {
+    return 1;
+  }
+  return cos(k * 3.14159265358979323846 / 16) * sqrt(2.0);
+}
+
+void DCTKernel::forward(double *block) {
+  switch(get_isa()) {
+#ifdef DCT_KERNEL_X86
+    case AVX512:
+      forward_avx512(block);
+      break;
+    case AVX2:
+      forward_avx2(block);
+      break;
+#endif
+    default:
+      forward_generic(block);
+      break;
+  }
+}
+
+void DCTKernel::inverse(double *block) {
+  switch(get_isa()) {
+#ifdef DCT_KERNEL_X86
+    case AVX512:
+      inverse_avx512(block);
+      break;
+    case AVX2:
+      inverse_avx2(block);
+      break;
+#endif
+    default:
+      inverse_generic(block);
+      break;
+  }
+}
+
+void DCTKernel::forward_islow(int *block) {
+  switch(get_isa()) {
+#ifdef DCT_KERNEL_X86
+    case AVX512:
+    case AVX2:
+      forward_islow_avx2(block);
+      break;
+    case SSE41:
+      forward_islow_sse41(block);
+      break;
+#endif
+    default:
+      forward_islow_generic(block);
+      break;
+  }
+}
+
+void DCTKernel::forward_islow(long long *block) {
+  forward_islow_generic(block);
+}
+
+void DCTKernel::inverse_islow(int *block) {
+  switch(get_isa()) {
+#ifdef DCT_KERNEL_X86
+    case AVX512:
+    case AVX2:
+      inverse_islow_avx2(block);
+      break;
+    case SSE41:
+      inverse_islow_sse41(block);
+      break;
+#endif
+    default:
+      inverse_islow_generic(block);
+      break;
+  }
+}
+
+void DCTKernel::inverse_islow(long long *block) {
+  inverse_islow_generic(block);
+}
+
+const char *DCTKernel::get_isa_name() {
+  switch(get_isa()) {
+    case AVX512:
+      return "AVX-512";
+    case AVX2:
+      return "AVX2";
+    case SSE41:
+      return "SSE4.1";
+    default:
+      return "generic";
+  }
+}
@@ -0,0 +1,59 @@
+#ifndef DCT_KERNEL_HPP
+#define DCT_KERNEL_HPP
+
+/**
+ * Separable 8x8 DCT and inverse DCT after Arai, Agui and Nakajima (AAN). A
+ * block is transformed row by row and then column by column with 5
+ * multiplications and 29 additions per 8 points instead of the 64
+ * multiplications of the matrix product.
+ *
+ * The outputs of forward() are the DCT coefficients scaled by
+ * 8 * get_scale(u) * get_scale(v), inverse() expects its inputs scaled by
+ * get_scale(u) * get_scale(v) and returns the samples scaled by 8. The scales
+ * are meant to be folded in to the quantisation tables, so a block is only
+ * multiplied once per cell before or after the transformation.
+ *
+ * The blocks are 64 cells, row after row.
+ *
+ * The kernel is chosen once by the instruction sets of the cpu: AVX-512 works
+ * on whole rows of 8 doubles and AVX2 on halves of a row - the columns are
+ * transformed as vectors of neighbouring columns and the rows as the columns
+ * of the transposed block. Other cpus use the scalar kernel, which the
+ * compiler vectorizes with the instructions of the baseline, e.g. SSE2.
+ * All kernels run the same operations in the same order on every cell and
+ * none of them fuses a multiplication with an addition, so the tolerance
+ * against the scalar kernel is 0 - the results are the same bit for bit and a
+ * picture is coded the same on every cpu.
+ *
+ * The islow kernels are the integer DCT of the independent JPEG group: the
+ * constants are fixed point numbers with 13 bits of fraction and every pass
+ * rounds by a shift, so their results only depend on the inputs - not on the
+ * cpu, the compiler or its flags. Blocks of int run on 8 lanes of AVX2 or 4
+ * lanes of SSE4.1, blocks of long long on the scalar kernel.
+ */
+namespace DCTKernel {
+  // 1 for k = 0, else cos(k * pi / 16) * sqrt(2)
+  double get_scale(const unsigned int &k);
+
+  // the scaled DCT of the block, in place
+  void forward(double *block);
+
+  // the scaled inverse DCT of the block, in place
+  void inverse(double *block);
+
+  // the integer DCT of the block, in place - the outputs are the DCT
+  // coefficients scaled by 8 and rounded; an int block has to keep its
+  // centered samples within +-799, else the intermediates overflow
+  void forward_islow(int *block);
+  void forward_islow(long long *block);
+
+  // the integer inverse DCT of the unscaled coefficients of the block, in
+  // place - the outputs are the rounded samples; an int block has to keep its
+  // coefficients within +-1173
+  void inverse_islow(int *block);
+  void inverse_islow(long long *block);
+
+  // returns the name of the instruction set the kernel uses on this machine
+  const char *get_isa_name();
+}
+#endif
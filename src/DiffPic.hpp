@@ -2,9 +2,10 @@
 #define DIFF_PIC_HPP 
 
 #include <math.h>
+#include <utility>
+#include <vector>
 
-#include "Matrix.hpp"
-#include "Pixel.hpp"
+#include "Image.hpp"
 #include "PPMFile.hpp"
 
 namespace DiffPicExce{
@@ -37,6 +38,7 @@ namespace DiffPicExce{
     }
 
    private:
+
     std::string msg;
   };
 }
@@ -56,10 +58,21 @@ public:
 
   // copy constructor
   DiffPic(const DiffPic &copy) {
-    pic_one_ = new Matrix<Pixel<double> >(copy.get_pic_one());    
-    pic_two_ = new Matrix<Pixel<double> >(copy.get_pic_two());
-    diff_pic_ = new Matrix<Pixel<double> >(copy.get_diff_pic());
-    rmse_ = get_rmse();
+    pic_one_ = new Image<double>(copy.get_pic_one());    
+    pic_two_ = new Image<double>(copy.get_pic_two());
+    diff_pic_ = new Image<double>(copy.get_diff_pic());
+    rmse_ = copy.get_rmse();
+  }
+
+  // move constructor
+  DiffPic(DiffPic &&other) {
+    pic_one_ = other.pic_one_;
+    pic_two_ = other.pic_two_;
+    diff_pic_ = other.diff_pic_;
+    rmse_ = other.rmse_;
+    other.pic_one_ = NULL;
+    other.pic_two_ = NULL;
+    other.diff_pic_ = NULL;
   }
 
   // Destructor
@@ -71,58 +84,135 @@ public:
 
   // calculates the difference between the pictures
   void calculate() {
-    if( pic_one_->get_row_length() != pic_two_->get_row_length()
-        && pic_one_->get_col_length() != pic_two_->get_col_length()) {
-      throw DiffPicExce::DimensionsNotIdentical(*pic_one_, *pic_two_);
-    }
-    diff_pic_ = new Matrix<Pixel<double> >((*pic_one_ - *pic_two_));
-    Matrix<Pixel<double> > rmse_mat = *diff_pic_;
+    check_dimensions();
+
+    unsigned int rows = pic_one_->get_row_length();
+    unsigned int cols = pic_one_->get_col_length();
+    unsigned char channels = pic_one_->get_channels();
+    double squared = 0;
+
+    delete diff_pic_;
+    diff_pic_ = NULL;
+    diff_pic_ = pic_one_->is_file_backed()
+                ? new Image<double>(rows, cols, 1, FileBacked())
+                : new Image<double>(rows, cols, 1);
+    Matrix<double> &grey = diff_pic_->get_plane(0);
+
+    // the pictures are compared in bands of rows, the grey value of a pixel is
+    // the average of its channels - a band of file backed pictures is dropped
+    // from the memory once it is done
+    std::vector<double> totals
+        = MatrixExprDetail::reduce_bands<std::vector<double> >(rows, cols,
+            [this, &grey, channels, cols](unsigned int begin,
+                                          unsigned int end) {
+              std::vector<double> partials(channels, 0.0);
+
+              for(unsigned char c = 0; c < channels; ++c) {
+                const Matrix<double> &one = pic_one_->get_plane(c);
+                const Matrix<double> &two = pic_two_->get_plane(c);
 
-    rmse_mat.pow(2);
-    rmse_ = sqrt(rmse_mat.get_total_value().get_grey().get_pixel(0) / 64);
+                for(unsigned int i = begin; i < end; ++i) {
+                  const double *one_row = one.get_row(i);
+                  const double *two_row = two.get_row(i);
+                  double *grey_row = grey.get_row(i);
 
-    // *diff_pic_ -= diff_pic_->get_min().grey().get_pixel(0);
-    // *diff_pic_ *= 255 / diff_pic_->get_max().grey().get_pixel(0);
-    *diff_pic_ += 128 ;
+                  for(unsigned int j = 0; j < cols; ++j) {
+                    double diff = one_row[j] - two_row[j];
 
-    for(unsigned int i = 0; i < diff_pic_->get_row_length(); ++i) {
-      for(unsigned int j = 0; j < diff_pic_->get_col_length(); ++j) {
-        diff_pic_->set_data(i, j, diff_pic_->get_data(i, j).grey());
-      }
+                    partials[c] += diff * diff;
+                    grey_row[j] += (diff + 128) / channels;
+                  }
+                }
+              }
+              pic_one_->advise(begin, end, MappedFile::DONT_NEED);
+              pic_two_->advise(begin, end, MappedFile::DONT_NEED);
+              diff_pic_->advise(begin, end, MappedFile::DONT_NEED);
+              return partials;
+            },
+            [](std::vector<double> &res, const std::vector<double> &partial) {
+              for(unsigned int c = 0; c < res.size(); ++c) {
+                res[c] += partial[c];
+              }
+            });
+
+    for(unsigned char c = 0; c < channels; ++c) {
+      squared += totals[c] / channels;
     }
+    rmse_ = sqrt(squared / 64);
   } 
 
+  // calculates the root mean square error of the grey values in the region of
+  // rows x cols pixels at row, col - the region is read in place, it is cut
+  // at the edges of the pictures
+  double get_region_rmse(const unsigned int &row,
+                         const unsigned int &col,
+                         unsigned int rows,
+                         unsigned int cols) const {
+    check_dimensions();
+
+    if(row + rows > pic_one_->get_row_length()) {
+      rows = pic_one_->get_row_length() - row;
+    }
+    if(col + cols > pic_one_->get_col_length()) {
+      cols = pic_one_->get_col_length() - col;
+    }
+    unsigned char channels = pic_one_->get_channels();
+    double squared = 0;
+
+    for(unsigned char c = 0; c < channels; ++c) {
+      MatrixView<const double> one = get_pic_one().get_view(c, row, col,
+                                                            rows, cols);
+      MatrixView<const double> two = get_pic_two().get_view(c, row, col,
+                                                            rows, cols);
+
+      squared += multiply_cells(one - two, one - two).get_total_value()
+                 / channels;
+    }
+    return sqrt(squared / ((double)rows * cols));
+  }
+
   //Wirtes the difference picture to a ppm file
   void write_to(const std::string filename) {  
     PPMFile<double> *p = new PPMFile<double>();
 
-    p->set_mat_pic(*diff_pic_, 255);
+    p->set_mat_pic(std::move(*diff_pic_), 255);
     p->set_magic_number(5);
     p->write_to(filename);
+    *diff_pic_ = p->release_mat_pic();
     delete p;
   }
 
-  inline void set_pic_one(const Matrix<Pixel<double> > &pic) {
+  inline void set_pic_one(const Image<double> &pic) {
+    set_pic_one(Image<double>(pic));
+  }
+
+  // takes over the picture without copying it
+  inline void set_pic_one(Image<double> &&pic) {
     delete pic_one_;
 
-    pic_one_ = new Matrix<Pixel<double> >(pic);
+    pic_one_ = new Image<double>(std::move(pic));
   }
 
-  inline Matrix<Pixel<double> > get_pic_one() const {
+  inline const Image<double> &get_pic_one() const {
     return *pic_one_;
   }
 
-  inline void set_pic_two(const Matrix<Pixel<double> > &pic) {
+  inline void set_pic_two(const Image<double> &pic) {
+    set_pic_two(Image<double>(pic));
+  }
+
+  // takes over the picture without copying it
+  inline void set_pic_two(Image<double> &&pic) {
     delete pic_two_;
 
-    pic_two_ = new Matrix<Pixel<double> >(pic);
+    pic_two_ = new Image<double>(std::move(pic));
   }
 
-  inline Matrix<Pixel<double> > get_pic_two() const {
-    return *pic_one_;
+  inline const Image<double> &get_pic_two() const {
+    return *pic_two_;
   }
 
-  inline Matrix<Pixel<double> > get_diff_pic() const {
+  inline const Image<double> &get_diff_pic() const {
     return *diff_pic_;
   }
 
@@ -130,23 +220,42 @@ public:
     return rmse_;
   }
 
-  DiffPic operator=(const DiffPic &copy) {
+  DiffPic &operator=(const DiffPic &copy) {
     if(this != &copy) {
       delete pic_one_;
-      pic_one_ = new Matrix<Pixel<double> >(copy.get_pic_one());    
+      pic_one_ = new Image<double>(copy.get_pic_one());    
       delete pic_two_;
-      pic_two_ = new Matrix<Pixel<double> >(copy.get_pic_two());
+      pic_two_ = new Image<double>(copy.get_pic_two());
       delete diff_pic_;
-      diff_pic_ = new Matrix<Pixel<double> >(copy.get_diff_pic());
-      rmse_ = get_rmse();
+      diff_pic_ = new Image<double>(copy.get_diff_pic());
+      rmse_ = copy.get_rmse();
+    }
+    return *this;
+  }
+
+  DiffPic &operator=(DiffPic &&rhs) {
+    if(this != &rhs) {
+      std::swap(pic_one_, rhs.pic_one_);
+      std::swap(pic_two_, rhs.pic_two_);
+      std::swap(diff_pic_, rhs.diff_pic_);
+      rmse_ = rhs.rmse_;
     }
     return *this;
   }
 
 private: 
-  Matrix<Pixel<double> > *pic_one_;
-  Matrix<Pixel<double> > *pic_two_;
-  Matrix<Pixel<double> > *diff_pic_;
+  // throws if the pictures differ in size or in the amount of channels
+  void check_dimensions() const {
+    if( pic_one_->get_row_length() != pic_two_->get_row_length()
+        || pic_one_->get_col_length() != pic_two_->get_col_length()
+        || pic_one_->get_channels() != pic_two_->get_channels()) {
+      throw DiffPicExce::DimensionsNotIdentical(*pic_one_, *pic_two_);
+    }
+  }
+
+  Image<double> *pic_one_;
+  Image<double> *pic_two_;
+  Image<double> *diff_pic_;
   double rmse_;
 };
 #endif
@@ -0,0 +1,184 @@
+#ifndef FIXED_MATRIX_HPP
+#define FIXED_MATRIX_HPP
+
+#include <sstream>
+
+#include "Matrix.hpp"
+
+/**
+ * The FixedMatrix class is a Matrix with R rows and C columns that are known at
+ * compile time. The cells are stored inline, so a FixedMatrix never touches
+ * the heap, and the dimensions of the operands are checked while compiling
+ * instead of throwing MatrixExce::DimensionsNotIdentical.
+ */
+template <typename T, unsigned int R, unsigned int C>
+class FixedMatrix : public MatrixExpr<FixedMatrix<T, R, C> > {
+ public:
+  typedef T value_type;
+  static constexpr unsigned int ROWS = R;
+  static constexpr unsigned int COLS = C;
+  static constexpr bool IS_LEAF = true;
+  static constexpr bool IS_DIRECT = true;
+  static constexpr bool IS_LOCAL = true;
+
+  // Default Constructor - all cells are T()
+  constexpr FixedMatrix() : data_() {
+  }
+
+  // Constructor with all cells set to val
+  explicit FixedMatrix(const T &val) {
+    T *data = data_;
+    FixedLoop<R * C>::run([data, &val](unsigned int i) { data[i] = val; });
+  }
+
+  // Constructor that evaluates a matrix expression with the same dimensions
+  template <typename E>
+  FixedMatrix(const MatrixExpr<E> &expr) {
+    evaluate(expr.self());
+  }
+
+  //returns the length of the rows
+  static constexpr unsigned int get_row_length() {
+    return R;
+  }
+
+  //returns the length of the columns
+  static constexpr unsigned int get_col_length() {
+    return C;
+  }
+
+  // returns the cell at m, n - unchecked
+  inline T &operator()(const unsigned int &m, const unsigned int &n) {
+    return data_[m * C + n];
+  }
+
+  // returns the cell at m, n - unchecked
+  constexpr const T &operator()(const unsigned int &m,
+                                const unsigned int &n) const {
+    return data_[m * C + n];
+  }
+
+  // returns a pointer to the first cell of the row m - unchecked
+  inline T *get_row(const unsigned int &m) {
+    return data_ + m * C;
+  }
+
+  // returns a pointer to the first cell of the row m - unchecked
+  constexpr const T *get_row(const unsigned int &m) const {
+    return data_ + m * C;
+  }
+
+  // returns the matrix transposed - the cells are not copied
+  inline MatrixTransposeExpr<FixedMatrix<T, R, C> > transpose() const {
+    return MatrixTransposeExpr<FixedMatrix<T, R, C> >(*this);
+  }
+
+  // evaluates the matrix expression in to the matrix
+  template <typename E>
+  FixedMatrix<T, R, C> &operator=(const MatrixExpr<E> &expr) {
+    if(E::IS_LOCAL) {
+      evaluate(expr.self());
+    } else {
+      FixedMatrix<T, R, C> result = FixedMatrix<T, R, C>(expr);
+      *this = result;
+    }
+    return *this;
+  }
+
+  // transforms the matrix to a sting readable for a human
+  std::string to_string() const {
+    std::ostringstream ss;
+
+    for(unsigned int i = 0; i < R; i++) {
+      for(unsigned int j = 0; j < C; j++) {
+       ss  << (*this)(i, j) << ' ';
+      }
+      ss << '\n';
+    }
+    ss << '\n';
+
+    return ss.str();
+  }
+
+  template <typename TParam, unsigned int RP, unsigned int CP>
+  FixedMatrix<T, R, C> &operator+=(const FixedMatrix<TParam, RP, CP> &rhs) {
+    static_assert(R == RP && C == CP, "FixedMatrix: Dimensions did not agree");
+    T *data = data_;
+    const TParam *rhs_data = rhs.get_row(0);
+
+    FixedLoop<R * C>::run([data, rhs_data](unsigned int i) {
+      data[i] += rhs_data[i];
+    });
+    return *this;
+  }
+
+  template <typename TParam, unsigned int RP, unsigned int CP>
+  FixedMatrix<T, R, C> &operator-=(const FixedMatrix<TParam, RP, CP> &rhs) {
+    static_assert(R == RP && C == CP, "FixedMatrix: Dimensions did not agree");
+    T *data = data_;
+    const TParam *rhs_data = rhs.get_row(0);
+
+    FixedLoop<R * C>::run([data, rhs_data](unsigned int i) {
+      data[i] -= rhs_data[i];
+    });
+    return *this;
+  }
+
+  // adds the value to every cell
+  FixedMatrix<T, R, C> &operator+=(const T &rhs) {
+    T *data = data_;
+
+    FixedLoop<R * C>::run([data, &rhs](unsigned int i) { data[i] += rhs; });
+    return *this;
+  }
+
+  // subtracts the value from every cell
+  FixedMatrix<T, R, C> &operator-=(const T &rhs) {
+    T *data = data_;
+
+    FixedLoop<R * C>::run([data, &rhs](unsigned int i) { data[i] -= rhs; });
+    return *this;
+  }
+
+  // multiplies every cell with the value
+  FixedMatrix<T, R, C> &operator*=(const T &rhs) {
+    T *data = data_;
+
+    FixedLoop<R * C>::run([data, &rhs](unsigned int i) { data[i] *= rhs; });
+    return *this;
+  }
+
+  // divides every cell by the value
+  FixedMatrix<T, R, C> &operator/=(const T &rhs) {
+    T *data = data_;
+
+    FixedLoop<R * C>::run([data, &rhs](unsigned int i) { data[i] /= rhs; });
+    return *this;
+  }
+
+  template <typename E>
+  FixedMatrix<T, R, C> &operator*=(const MatrixExpr<E> &rhs) {
+    return *this = *this * rhs.self();
+  }
+
+ private:
+  // calculates all cells of the expression in to the matrix - the expression
+  // must not read cells of the matrix other than the one being written
+  template <typename E>
+  inline void evaluate(const E &expr) {
+    MatrixExprDetail::Dimension<R, E::ROWS>();
+    MatrixExprDetail::Dimension<C, E::COLS>();
+
+    if(expr.get_row_length() != R || expr.get_col_length() != C) {
+      throw MatrixExce::DimensionsNotIdentical(*this, expr);
+    }
+    T *data = data_;
+
+    FixedLoop<R * C>::run([data, &expr](unsigned int i) {
+      data[i] = expr(i / C, i % C);
+    });
+  }
+
+  T data_[R * C];
+};
+#endif
@@ -0,0 +1,475 @@
+#include <stdlib.h>
+#include <algorithm>
+#include <new>
+
+#include "Gemm.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GEMM_X86
+#endif
+
+namespace {
+  // rows of a tile of the result that a micro kernel calculates
+  const unsigned int MR = 4;
+  // depth of the packed panels - a KC x NR panel of b stays in L1
+  const unsigned int KC = 256;
+  // rows of a that are packed at once - MC x KC cells stay in L2
+  const unsigned int MC = 128;
+  // columns of b that are packed at once - KC x NC cells stay in L3
+  const unsigned int NC = 2048;
+
+  enum Isa { GENERIC, SSE2, AVX2 };
+
+  // asks the cpu once which micro kernel can be used
+  Isa get_isa() {
+    static const Isa isa = []() {
+#ifdef GEMM_X86
+      __builtin_cpu_init();
+      if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return AVX2;
+      }
+      if(__builtin_cpu_supports("sse2")) {
+        return SSE2;
+      }
+#endif
+      return GENERIC;
+    }();
+    return isa;
+  }
+
+  // 64 byte aligned scratch memory for the packed panels
+  template <typename T>
+  class Buffer {
+   public:
+    explicit Buffer(const std::size_t &cells) {
+      void *memory = NULL;
+
+      if(posix_memalign(&memory, 64, cells * sizeof(T)) != 0) {
+        throw std::bad_alloc();
+      }
+      data_ = static_cast<T *>(memory);
+    }
+
+    ~Buffer() {
+      free(data_);
+    }
+
+    inline T *get() const {
+      return data_;
+    }
+
+   private:
+    Buffer(const Buffer &);
+    Buffer &operator=(const Buffer &);
+
+    T *data_;
+  };
+
+  template <typename T>
+  inline const T &get_cell(const Gemm::Operand<T> &operand,
+                           const unsigned int &m,
+                           const unsigned int &n) {
+    if(operand.transposed) {
+      return operand.data[(std::size_t)n * operand.stride + m];
+    }
+    return operand.data[(std::size_t)m * operand.stride + n];
+  }
+
+  // copies mc x kc cells of a at row, depth in to panels of MR rows - a panel
+  // holds the MR cells of one column after each other, missing rows are 0
+  template <typename T>
+  void pack_a(const Gemm::Operand<T> &a,
+              const unsigned int &row,
+              const unsigned int &depth,
+              const unsigned int &mc,
+              const unsigned int &kc,
+              T *packed) {
+    for(unsigned int i = 0; i < mc; i += MR) {
+      unsigned int rows = std::min(MR, mc - i);
+
+      for(unsigned int p = 0; p < kc; ++p) {
+        unsigned int r = 0;
+
+        for(; r < rows; ++r) {
+          packed[r] = get_cell(a, row + i + r, depth + p);
+        }
+        for(; r < MR; ++r) {
+          packed[r] = T();
+        }
+        packed += MR;
+      }
+    }
+  }
+
+  // copies kc x nc cells of b at depth, col in to panels of NR columns - a
+  // panel holds the NR cells of one row after each other, missing columns are
+  // 0
+  template <typename T, unsigned int NR>
+  void pack_b(const Gemm::Operand<T> &b,
+              const unsigned int &depth,
+              const unsigned int &col,
+              const unsigned int &kc,
+              const unsigned int &nc,
+              T *packed) {
+    for(unsigned int j = 0; j < nc; j += NR) {
+      unsigned int cols = std::min(NR, nc - j);
+
+      for(unsigned int p = 0; p < kc; ++p) {
+        unsigned int c = 0;
+
+        for(; c < cols; ++c) {
+          packed[c] = get_cell(b, depth + p, col + j + c);
+        }
+        for(; c < NR; ++c) {
+          packed[c] = T();
+        }
+        packed += NR;
+      }
+    }
+  }
+
+  // calculates the MR x NR tile c (+)= a * b of a packed panel of a and b
+  template <typename T, unsigned int NR>
+  void kernel_generic(const unsigned int &kc,
+                      const T *a,
+                      const T *b,
+                      T *c,
+                      const std::size_t &c_stride,
+                      const bool &accumulate) {
+    T tile[MR][NR] = {};
+
+    for(unsigned int p = 0; p < kc; ++p) {
+      for(unsigned int r = 0; r < MR; ++r) {
+        for(unsigned int j = 0; j < NR; ++j) {
+          tile[r][j] += a[r] * b[j];
+        }
+      }
+      a += MR;
+      b += NR;
+    }
+
+    for(unsigned int r = 0; r < MR; ++r) {
+      T *c_row = c + r * c_stride;
+
+      for(unsigned int j = 0; j < NR; ++j) {
+        c_row[j] = accumulate ? c_row[j] + tile[r][j] : tile[r][j];
+      }
+    }
+  }
+
+#ifdef GEMM_X86
+  __attribute__((target("avx2,fma")))
+  void kernel_avx2(const unsigned int &kc,
+                   const double *a,
+                   const double *b,
+                   double *c,
+                   const std::size_t &c_stride,
+                   const bool &accumulate) {
+    __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+    __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+    __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+    __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+
+    for(unsigned int p = 0; p < kc; ++p) {
+      __m256d b0 = _mm256_load_pd(b);
+      __m256d b1 = _mm256_load_pd(b + 4);
+      __m256d ai = _mm256_broadcast_sd(a);
+
+      c00 = _mm256_fmadd_pd(ai, b0, c00);
+      c01 = _mm256_fmadd_pd(ai, b1, c01);
+      ai = _mm256_broadcast_sd(a + 1);
+      c10 = _mm256_fmadd_pd(ai, b0, c10);
+      c11 = _mm256_fmadd_pd(ai, b1, c11);
+      ai = _mm256_broadcast_sd(a + 2);
+      c20 = _mm256_fmadd_pd(ai, b0, c20);
+      c21 = _mm256_fmadd_pd(ai, b1, c21);
+      ai = _mm256_broadcast_sd(a + 3);
+      c30 = _mm256_fmadd_pd(ai, b0, c30);
+      c31 = _mm256_fmadd_pd(ai, b1, c31);
+      a += MR;
+      b += 8;
+    }
+
+    __m256d *tile[MR][2] = {{&c00, &c01}, {&c10, &c11},
+                            {&c20, &c21}, {&c30, &c31}};
+
+    for(unsigned int r = 0; r < MR; ++r) {
+      double *c_row = c + r * c_stride;
+
+      if(accumulate) {
+        *tile[r][0] = _mm256_add_pd(_mm256_loadu_pd(c_row), *tile[r][0]);
+        *tile[r][1] = _mm256_add_pd(_mm256_loadu_pd(c_row + 4), *tile[r][1]);
+      }
+      _mm256_storeu_pd(c_row, *tile[r][0]);
+      _mm256_storeu_pd(c_row + 4, *tile[r][1]);
+    }
+  }
+
+  __attribute__((target("avx2,fma")))
+  void kernel_avx2(const unsigned int &kc,
+                   const float *a,
+                   const float *b,
+                   float *c,
+                   const std::size_t &c_stride,
+                   const bool &accumulate) {
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+    __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+
+    for(unsigned int p = 0; p < kc; ++p) {
+      __m256 b0 = _mm256_load_ps(b);
+      __m256 b1 = _mm256_load_ps(b + 8);
+      __m256 ai = _mm256_broadcast_ss(a);
+
+      c00 = _mm256_fmadd_ps(ai, b0, c00);
+      c01 = _mm256_fmadd_ps(ai, b1, c01);
+      ai = _mm256_broadcast_ss(a + 1);
+      c10 = _mm256_fmadd_ps(ai, b0, c10);
+      c11 = _mm256_fmadd_ps(ai, b1, c11);
+      ai = _mm256_broadcast_ss(a + 2);
+      c20 = _mm256_fmadd_ps(ai, b0, c20);
+      c21 = _mm256_fmadd_ps(ai, b1, c21);
+      ai = _mm256_broadcast_ss(a + 3);
+      c30 = _mm256_fmadd_ps(ai, b0, c30);
+      c31 = _mm256_fmadd_ps(ai, b1, c31);
+      a += MR;
+      b += 16;
+    }
+
+    __m256 *tile[MR][2] = {{&c00, &c01}, {&c10, &c11},
+                           {&c20, &c21}, {&c30, &c31}};
+
+    for(unsigned int r = 0; r < MR; ++r) {
+      float *c_row = c + r * c_stride;
+
+      if(accumulate) {
+        *tile[r][0] = _mm256_add_ps(_mm256_loadu_ps(c_row), *tile[r][0]);
+        *tile[r][1] = _mm256_add_ps(_mm256_loadu_ps(c_row + 8), *tile[r][1]);
+      }
+      _mm256_storeu_ps(c_row, *tile[r][0]);
+      _mm256_storeu_ps(c_row + 8, *tile[r][1]);
+    }
+  }
+
+  __attribute__((target("sse2")))
+  void kernel_sse2(const unsigned int &kc,
+                   const double *a,
+                   const double *b,
+                   double *c,
+                   const std::size_t &c_stride,
+                   const bool &accumulate) {
+    __m128d c00 = _mm_setzero_pd(), c01 = _mm_setzero_pd();
+    __m128d c10 = _mm_setzero_pd(), c11 = _mm_setzero_pd();
+    __m128d c20 = _mm_setzero_pd(), c21 = _mm_setzero_pd();
+    __m128d c30 = _mm_setzero_pd(), c31 = _mm_setzero_pd();
+
+    for(unsigned int p = 0; p < kc; ++p) {
+      __m128d b0 = _mm_load_pd(b);
+      __m128d b1 = _mm_load_pd(b + 2);
+      __m128d ai = _mm_load1_pd(a);
+
+      c00 = _mm_add_pd(c00, _mm_mul_pd(ai, b0));
+      c01 = _mm_add_pd(c01, _mm_mul_pd(ai, b1));
+      ai = _mm_load1_pd(a + 1);
+      c10 = _mm_add_pd(c10, _mm_mul_pd(ai, b0));
+      c11 = _mm_add_pd(c11, _mm_mul_pd(ai, b1));
+      ai = _mm_load1_pd(a + 2);
+      c20 = _mm_add_pd(c20, _mm_mul_pd(ai, b0));
+      c21 = _mm_add_pd(c21, _mm_mul_pd(ai, b1));
+      ai = _mm_load1_pd(a + 3);
+      c30 = _mm_add_pd(c30, _mm_mul_pd(ai, b0));
+      c31 = _mm_add_pd(c31, _mm_mul_pd(ai, b1));
+      a += MR;
+      b += 4;
+    }
+
+    __m128d *tile[MR][2] = {{&c00, &c01}, {&c10, &c11},
+                            {&c20, &c21}, {&c30, &c31}};
+
+    for(unsigned int r = 0; r < MR; ++r) {
+      double *c_row = c + r * c_stride;
+
+      if(accumulate) {
+        *tile[r][0] = _mm_add_pd(_mm_loadu_pd(c_row), *tile[r][0]);
+        *tile[r][1] = _mm_add_pd(_mm_loadu_pd(c_row + 2), *tile[r][1]);
+      }
+      _mm_storeu_pd(c_row, *tile[r][0]);
+      _mm_storeu_pd(c_row + 2, *tile[r][1]);
+    }
+  }
+
+  __attribute__((target("sse2")))
+  void kernel_sse2(const unsigned int &kc,
+                   const float *a,
+                   const float *b,
+                   float *c,
+                   const std::size_t &c_stride,
+                   const bool &accumulate) {
+    __m128 c00 = _mm_setzero_ps(), c01 = _mm_setzero_ps();
+    __m128 c10 = _mm_setzero_ps(), c11 = _mm_setzero_ps();
+    __m128 c20 = _mm_setzero_ps(), c21 = _mm_setzero_ps();
+    __m128 c30 = _mm_setzero_ps(), c31 = _mm_setzero_ps();
+
+    for(unsigned int p = 0; p < kc; ++p) {
+      __m128 b0 = _mm_load_ps(b);
+      __m128 b1 = _mm_load_ps(b + 4);
+      __m128 ai = _mm_load1_ps(a);
+
+      c00 = _mm_add_ps(c00, _mm_mul_ps(ai, b0));
+      c01 = _mm_add_ps(c01, _mm_mul_ps(ai, b1));
+      ai = _mm_load1_ps(a + 1);
+      c10 = _mm_add_ps(c10, _mm_mul_ps(ai, b0));
+      c11 = _mm_add_ps(c11, _mm_mul_ps(ai, b1));
+      ai = _mm_load1_ps(a + 2);
+      c20 = _mm_add_ps(c20, _mm_mul_ps(ai, b0));
+      c21 = _mm_add_ps(c21, _mm_mul_ps(ai, b1));
+      ai = _mm_load1_ps(a + 3);
+      c30 = _mm_add_ps(c30, _mm_mul_ps(ai, b0));
+      c31 = _mm_add_ps(c31, _mm_mul_ps(ai, b1));
+      a += MR;
+      b += 8;
+    }
+
+    __m128 *tile[MR][2] = {{&c00, &c01}, {&c10, &c11},
+                           {&c20, &c21}, {&c30, &c31}};
+
+    for(unsigned int r = 0; r < MR; ++r) {
+      float *c_row = c + r * c_stride;
+
+      if(accumulate) {
+        *tile[r][0] = _mm_add_ps(_mm_loadu_ps(c_row), *tile[r][0]);
+        *tile[r][1] = _mm_add_ps(_mm_loadu_ps(c_row + 4), *tile[r][1]);
+      }
+      _mm_storeu_ps(c_row, *tile[r][0]);
+      _mm_storeu_ps(c_row + 4, *tile[r][1]);
+    }
+  }
+#endif
+
+  // walks over the blocks of the product, packs them and lets the micro kernel
+  // calculate the tiles - tiles at the edges are calculated in to a scratch
+  // tile and only the valid cells are copied
+  template <typename T,
+            unsigned int NR,
+            void (*Kernel)(const unsigned int &, const T *, const T *, T *,
+                           const std::size_t &, const bool &)>
+  void multiply_blocked(const Gemm::Operand<T> &a,
+                        const Gemm::Operand<T> &b,
+                        T *c,
+                        const std::size_t &c_stride,
+                        const unsigned int &m,
+                        const unsigned int &n,
+                        const unsigned int &k) {
+    if(k == 0) {
+      for(unsigned int i = 0; i < m; ++i) {
+        std::fill(c + i * c_stride, c + i * c_stride + n, T());
+      }
+      return;
+    }
+    Buffer<T> a_packed((std::size_t)MC * KC);
+    Buffer<T> b_packed((std::size_t)KC * NC);
+    alignas(64) T tile[MR * NR];
+
+    for(unsigned int jc = 0; jc < n; jc += NC) {
+      unsigned int nc = std::min(NC, n - jc);
+
+      for(unsigned int pc = 0; pc < k; pc += KC) {
+        unsigned int kc = std::min(KC, k - pc);
+        bool accumulate = pc != 0;
+
+        pack_b<T, NR>(b, pc, jc, kc, nc, b_packed.get());
+
+        for(unsigned int ic = 0; ic < m; ic += MC) {
+          unsigned int mc = std::min(MC, m - ic);
+
+          pack_a(a, ic, pc, mc, kc, a_packed.get());
+
+          for(unsigned int jr = 0; jr < nc; jr += NR) {
+            const T *b_panel = b_packed.get() + (std::size_t)jr * kc;
+            unsigned int cols = std::min(NR, nc - jr);
+
+            for(unsigned int ir = 0; ir < mc; ir += MR) {
+              const T *a_panel = a_packed.get() + (std::size_t)ir * kc;
+              T *c_tile = c + (ic + ir) * c_stride + jc + jr;
+              unsigned int rows = std::min(MR, mc - ir);
+
+              if(rows == MR && cols == NR) {
+                Kernel(kc, a_panel, b_panel, c_tile, c_stride, accumulate);
+                continue;
+              }
+              Kernel(kc, a_panel, b_panel, tile, NR, false);
+
+              for(unsigned int r = 0; r < rows; ++r) {
+                T *c_row = c_tile + r * c_stride;
+
+                for(unsigned int j = 0; j < cols; ++j) {
+                  c_row[j] = accumulate ? c_row[j] + tile[r * NR + j]
+                                        : tile[r * NR + j];
+                }
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  template <typename T>
+  void multiply_dispatch(const Gemm::Operand<T> &a,
+                         const Gemm::Operand<T> &b,
+                         T *c,
+                         const std::size_t &c_stride,
+                         const unsigned int &m,
+                         const unsigned int &n,
+                         const unsigned int &k) {
+    switch(get_isa()) {
+#ifdef GEMM_X86
+      case AVX2:
+        multiply_blocked<T, 32 / sizeof(T) * 2, kernel_avx2>(a, b, c, c_stride,
+                                                             m, n, k);
+        break;
+      case SSE2:
+        multiply_blocked<T, 16 / sizeof(T) * 2, kernel_sse2>(a, b, c, c_stride,
+                                                             m, n, k);
+        break;
+#endif
+      default:
+        multiply_blocked<T, 4, kernel_generic<T, 4> >(a, b, c, c_stride,
+                                                      m, n, k);
+        break;
+    }
+  }
+}
+
+void Gemm::multiply(const Operand<float> &a,
+                    const Operand<float> &b,
+                    float *c,
+                    const std::size_t &c_stride,
+                    const unsigned int &m,
+                    const unsigned int &n,
+                    const unsigned int &k) {
+  multiply_dispatch(a, b, c, c_stride, m, n, k);
+}
+
+void Gemm::multiply(const Operand<double> &a,
+                    const Operand<double> &b,
+                    double *c,
+                    const std::size_t &c_stride,
+                    const unsigned int &m,
+                    const unsigned int &n,
+                    const unsigned int &k) {
+  multiply_dispatch(a, b, c, c_stride, m, n, k);
+}
+
+const char *Gemm::get_isa_name() {
+  switch(get_isa()) {
+    case AVX2:
+      return "AVX2";
+    case SSE2:
+      return "SSE2";
+    default:
+      return "generic";
+  }
+}
@@ -0,0 +1,61 @@
+#ifndef GEMM_HPP
+#define GEMM_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * Cache and register blocked matrix multiplication for float and double.
+ * The operands are packed in to panels that stay in the caches while a small
+ * micro kernel keeps a tile of the result in vector registers. The micro
+ * kernel is chosen once at runtime - AVX2 with FMA, SSE2 or plain C++.
+ *
+ * The kernel sums the products in an other order than the textbook loop (and
+ * with fused multiply adds on AVX2), so the cells may differ from the generic
+ * Matrix product in the last bits.
+ */
+namespace Gemm {
+  // true for the types the blocked kernel is available for
+  template <typename T> struct IsSupported : std::false_type {
+  };
+
+  template <> struct IsSupported<float> : std::true_type {
+  };
+
+  template <> struct IsSupported<double> : std::true_type {
+  };
+
+  // products with less multiplications than this are not worth the packing
+  const std::size_t MIN_MULTIPLICATIONS = 16 * 16 * 16;
+
+  // an operand of the product - the cell at m, n is data[m * stride + n] or
+  // data[n * stride + m] if the operand is transposed
+  template <typename T>
+  struct Operand {
+    const T *data;
+    std::size_t stride;
+    bool transposed;
+  };
+
+  // c = a * b - a is m x k, b is k x n and c is m x n, c must not overlap
+  // with a or b
+  void multiply(const Operand<float> &a,
+                const Operand<float> &b,
+                float *c,
+                const std::size_t &c_stride,
+                const unsigned int &m,
+                const unsigned int &n,
+                const unsigned int &k);
+
+  void multiply(const Operand<double> &a,
+                const Operand<double> &b,
+                double *c,
+                const std::size_t &c_stride,
+                const unsigned int &m,
+                const unsigned int &n,
+                const unsigned int &k);
+
+  // returns the name of the instruction set the kernel uses on this machine
+  const char *get_isa_name();
+}
+#endif
@@ -129,7 +129,7 @@ bool Huffile::get_mode() const {
  * @param data_vector is a vector that holds all characters of the file to be 
  *                    processed
  */
-void Huffile::set_data(std::vector<unsigned char> data_vector) {
+void Huffile::set_data(const std::vector<unsigned char> &data_vector) {
   if(encoding_) {
     encode(data_vector);
   } else {
@@ -140,14 +140,14 @@ void Huffile::set_data(std::vector<unsigned char> data_vector) {
 /**
  * @return the return value is the encoded data
  */
-std::string Huffile::get_encoded_data() const {
+const std::string &Huffile::get_encoded_data() const {
   return *encoded_data_;
 }
 
 /**
  * @return the return value is the decoded data
  */
-std::string Huffile::get_decoded_data() const {
+const std::string &Huffile::get_decoded_data() const {
   return *decoded_data_;
 }
 
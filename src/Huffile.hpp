@@ -23,9 +23,9 @@ public:
   void write_decoded_to(const std::string &filename) const;
   void set_mode(const bool &encoding);
   bool get_mode() const;
-  void set_data(std::vector<unsigned char> data_vector);
-  std::string get_encoded_data() const;
-  std::string get_decoded_data() const;
+  void set_data(const std::vector<unsigned char> &data_vector);
+  const std::string &get_encoded_data() const;
+  const std::string &get_decoded_data() const;
   double get_decoded_data_size() const;
   double get_encoded_data_size() const;
   Huffile operator=(const Huffile &copy);
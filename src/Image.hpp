@@ -0,0 +1,287 @@
+#ifndef IMAGE_HPP
+#define IMAGE_HPP
+
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Matrix.hpp"
+#include "Pixel.hpp"
+
+/**
+ * The Image class is a picture with one plane per channel (e.g. R, G and B)
+ * instead of one Pixel per cell. Every plane is a Matrix<T> - one aligned
+ * buffer - so a picture needs get_channels() allocations instead of one per
+ * pixel, and a loop over one channel reads consecutive memory.
+ *
+ * The planes can be iterated with begin() / end() and a part of a plane can be
+ * read and written in place through get_view().
+ *
+ * The planes of a FileBacked image are stored in scratch files, so the image
+ * may be larger than the RAM (see Matrix::advise()).
+ */
+template <typename T> class Image {
+ public:
+  typedef T value_type;
+  typedef typename std::vector<Matrix<T> >::iterator iterator;
+  typedef typename std::vector<Matrix<T> >::const_iterator const_iterator;
+
+  // Default constructor - an image without any plane
+  Image() {
+    rows_ = 0;
+    cols_ = 0;
+  }
+
+  // Constructor with m rows, n columns and the amount of channels, all cells
+  // are val
+  Image(const unsigned int &m,
+        const unsigned int &n,
+        const unsigned char &channels,
+        const T &val = T()) {
+    rows_ = m;
+    cols_ = n;
+    planes_.reserve(channels);
+
+    for(unsigned char c = 0; c < channels; ++c) {
+      planes_.push_back(Matrix<T>(m, n, val));
+    }
+  }
+
+  // Constructor with m rows, n columns and the amount of channels, the planes
+  // are stored in scratch files and all cells are 0
+  Image(const unsigned int &m,
+        const unsigned int &n,
+        const unsigned char &channels,
+        const FileBacked &backing) {
+    rows_ = m;
+    cols_ = n;
+    planes_.reserve(channels);
+
+    for(unsigned char c = 0; c < channels; ++c) {
+      planes_.push_back(Matrix<T>(m, n, backing));
+    }
+  }
+
+  // Constructor that splits a matrix of pixels in to planes - every pixel
+  // needs as many subpixels as the first one
+  explicit Image(const Matrix<Pixel<T> > &pixels) {
+    rows_ = pixels.get_row_length();
+    cols_ = pixels.get_col_length();
+
+    unsigned char channels = (rows_ == 0 || cols_ == 0) ? 0
+                             : pixels(0, 0).size();
+
+    for(unsigned char c = 0; c < channels; ++c) {
+      planes_.push_back(Matrix<T>(rows_, cols_));
+    }
+
+    for(unsigned int i = 0; i < rows_; ++i) {
+      const Pixel<T> *row = pixels.get_row(i);
+
+      for(unsigned int j = 0; j < cols_; ++j) {
+        set_pixel(i, j, row[j]);
+      }
+    }
+  }
+
+  // copy constructor
+  Image(const Image<T> &copy) : planes_(copy.planes_) {
+    rows_ = copy.rows_;
+    cols_ = copy.cols_;
+  }
+
+  // move constructor - takes over the planes of other, other will be empty
+  Image(Image<T> &&other) noexcept : planes_(std::move(other.planes_)) {
+    rows_ = other.rows_;
+    cols_ = other.cols_;
+    other.planes_.clear();
+    other.rows_ = 0;
+    other.cols_ = 0;
+  }
+
+  //returns the length of the rows
+  inline unsigned int get_row_length() const {
+    return rows_;
+  }
+
+  //returns the length of the columns
+  inline unsigned int get_col_length() const {
+    return cols_;
+  }
+
+  // returns the amount of channels - the subpixels of one pixel
+  inline unsigned char get_channels() const {
+    return planes_.size();
+  }
+
+  // returns the plane of the channel c - unchecked
+  inline Matrix<T> &get_plane(const unsigned char &c) {
+    return planes_[c];
+  }
+
+  // returns the plane of the channel c - unchecked
+  inline const Matrix<T> &get_plane(const unsigned char &c) const {
+    return planes_[c];
+  }
+
+  // returns true if the planes are stored in scratch files
+  inline bool is_file_backed() const {
+    return !planes_.empty() && planes_[0].is_file_backed();
+  }
+
+  // passes the advice for the rows [begin, end) of all planes to the kernel
+  inline void advise(const unsigned int &begin,
+                     const unsigned int &end,
+                     const MappedFile::Advice &advice) const {
+    for(unsigned char c = 0; c < get_channels(); ++c) {
+      planes_[c].advise(begin, end, advice);
+    }
+  }
+
+  inline iterator begin() {
+    return planes_.begin();
+  }
+
+  inline iterator end() {
+    return planes_.end();
+  }
+
+  inline const_iterator begin() const {
+    return planes_.begin();
+  }
+
+  inline const_iterator end() const {
+    return planes_.end();
+  }
+
+  // returns the cell at m, n of the channel c - unchecked
+  inline T &operator()(const unsigned int &m,
+                       const unsigned int &n,
+                       const unsigned char &c) {
+    return planes_[c](m, n);
+  }
+
+  // returns the cell at m, n of the channel c - unchecked
+  inline const T &operator()(const unsigned int &m,
+                             const unsigned int &n,
+                             const unsigned char &c) const {
+    return planes_[c](m, n);
+  }
+
+  // returns the cell at m, n of the channel c
+  inline T get_data(const unsigned int &m,
+                    const unsigned int &n,
+                    const unsigned char &c) const {
+    check_channel(c);
+    return planes_[c].get_data(m, n);
+  }
+
+  // sets the cell at m, n of the channel c
+  inline void set_data(const unsigned int &m,
+                       const unsigned int &n,
+                       const unsigned char &c,
+                       const T &val) {
+    check_channel(c);
+    planes_[c].set_data(m, n, val);
+  }
+
+  // returns a view of rows x cols cells of the channel c starting at row, col
+  // - the cells that reach over the edges of the image are T()
+  inline MatrixView<T> get_view(const unsigned char &c,
+                                const unsigned int &row,
+                                const unsigned int &col,
+                                const unsigned int &rows,
+                                const unsigned int &cols) {
+    check_channel(c);
+    return planes_[c].get_view(row, col, rows, cols);
+  }
+
+  // returns a read only view of rows x cols cells of the channel c starting at
+  // row, col - the cells that reach over the edges of the image are T()
+  inline MatrixView<const T> get_view(const unsigned char &c,
+                                      const unsigned int &row,
+                                      const unsigned int &col,
+                                      const unsigned int &rows,
+                                      const unsigned int &cols) const {
+    check_channel(c);
+    return planes_[c].get_view(row, col, rows, cols);
+  }
+
+  // returns the subpixels at m, n as a Pixel
+  Pixel<T> get_pixel(const unsigned int &m, const unsigned int &n) const {
+    Pixel<T> pixel = Pixel<T>(get_channels());
+
+    for(unsigned char c = 0; c < get_channels(); ++c) {
+      pixel.set_pixel(c, planes_[c].get_data(m, n));
+    }
+    return pixel;
+  }
+
+  // sets the subpixels at m, n to the ones of the pixel
+  void set_pixel(const unsigned int &m,
+                 const unsigned int &n,
+                 const Pixel<T> &pixel) {
+    if(pixel.size() != get_channels()) {
+      std::ostringstream ss;
+      ss << "The pixel has " << (int)pixel.size() << " subpixels, the image "
+      << "has " << (int)get_channels() << " channels\n";
+      throw std::range_error(ss.str());
+    }
+
+    for(unsigned char c = 0; c < get_channels(); ++c) {
+      planes_[c].set_data(m, n, pixel.get_pixel(c));
+    }
+  }
+
+  // returns the image as a matrix of pixels
+  Matrix<Pixel<T> > to_pixel_matrix() const {
+    Matrix<Pixel<T> > pixels = Matrix<Pixel<T> >(rows_, cols_);
+
+    for(unsigned int i = 0; i < rows_; ++i) {
+      Pixel<T> *row = pixels.get_row(i);
+
+      for(unsigned int j = 0; j < cols_; ++j) {
+        row[j] = get_pixel(i, j);
+      }
+    }
+    return pixels;
+  }
+
+  Image<T> &operator=(const Image<T> &rhs) {
+    if(this != &rhs) {
+      planes_ = rhs.planes_;
+      rows_ = rhs.rows_;
+      cols_ = rhs.cols_;
+    }
+    return *this;
+  }
+
+  // move assignment - takes over the planes of rhs, rhs will be empty
+  Image<T> &operator=(Image<T> &&rhs) noexcept {
+    if(this != &rhs) {
+      planes_ = std::move(rhs.planes_);
+      rows_ = rhs.rows_;
+      cols_ = rhs.cols_;
+      rhs.planes_.clear();
+      rhs.rows_ = 0;
+      rhs.cols_ = 0;
+    }
+    return *this;
+  }
+
+ private:
+  inline void check_channel(const unsigned char &c) const {
+    if(c >= planes_.size()) {
+      std::ostringstream ss;
+      ss << "Image channel out of range\n" << "channel: " << (int)c
+      << "\tchannels: " << planes_.size() << '\n';
+      throw std::out_of_range(ss.str());
+    }
+  }
+
+  std::vector<Matrix<T> > planes_;
+  unsigned int rows_;
+  unsigned int cols_;
+};
+#endif
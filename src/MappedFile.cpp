@@ -0,0 +1,127 @@
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MappedFile.hpp"
+
+namespace {
+  std::string get_error(const std::string &what) {
+    return what + ": " + std::strerror(errno);
+  }
+}
+
+MappedFile::MappedFile(const std::string &filename) {
+  data_ = NULL;
+  size_ = 0;
+  fd_ = open(filename.c_str(), O_RDONLY);
+
+  if(fd_ == -1) {
+    throw MappedFileExce::CouldNotMap(get_error("open " + filename));
+  }
+  struct stat status;
+
+  if(fstat(fd_, &status) != 0) {
+    std::string error = get_error("fstat " + filename);
+    close(fd_);
+    throw MappedFileExce::CouldNotMap(error);
+  }
+  size_ = status.st_size;
+
+  if(size_ == 0) {
+    return;
+  }
+  void *data = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+
+  if(data == MAP_FAILED) {
+    std::string error = get_error("mmap " + filename);
+    close(fd_);
+    throw MappedFileExce::CouldNotMap(error);
+  }
+  data_ = static_cast<char *>(data);
+}
+
+MappedFile::MappedFile(const std::string &directory, const std::size_t &size) {
+  data_ = NULL;
+  size_ = size;
+
+  std::string name = directory + "/matrix-XXXXXX";
+  std::vector<char> path(name.begin(), name.end());
+  path.push_back('\0');
+
+  fd_ = mkstemp(&path[0]);
+
+  if(fd_ == -1) {
+    throw MappedFileExce::CouldNotMap(get_error("mkstemp " + name));
+  }
+  unlink(&path[0]);
+
+  if(size_ == 0) {
+    return;
+  }
+
+  if(ftruncate(fd_, size_) != 0) {
+    std::string error = get_error("ftruncate");
+    close(fd_);
+    throw MappedFileExce::CouldNotMap(error);
+  }
+  void *data = mmap(NULL, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+
+  if(data == MAP_FAILED) {
+    std::string error = get_error("mmap");
+    close(fd_);
+    throw MappedFileExce::CouldNotMap(error);
+  }
+  data_ = static_cast<char *>(data);
+}
+
+MappedFile::~MappedFile() {
+  if(data_ != NULL) {
+    munmap(data_, size_);
+  }
+  close(fd_);
+}
+
+void MappedFile::advise(const std::size_t &offset,
+                        const std::size_t &length,
+                        const Advice &advice) const {
+  if(data_ == NULL || offset >= size_ || length == 0) {
+    return;
+  }
+  std::size_t page = get_page_size();
+  std::size_t begin = offset / page * page;
+  std::size_t end = (length > size_ - offset) ? size_ : offset + length;
+  int hint = MADV_NORMAL;
+
+  switch(advice) {
+  case NORMAL:
+    hint = MADV_NORMAL;
+    break;
+  case SEQUENTIAL:
+    hint = MADV_SEQUENTIAL;
+    break;
+  case RANDOM:
+    hint = MADV_RANDOM;
+    break;
+  case WILL_NEED:
+    hint = MADV_WILLNEED;
+    break;
+  case DONT_NEED:
+    hint = MADV_DONTNEED;
+    break;
+  }
+
+  if(begin < end) {
+    madvise(data_ + begin, end - begin, hint);
+  }
+}
+
+std::size_t MappedFile::get_page_size() {
+  static const std::size_t page = sysconf(_SC_PAGESIZE);
+  return page;
+}
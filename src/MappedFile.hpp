@@ -0,0 +1,98 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <exception>
+#include <string>
+
+namespace MappedFileExce {
+  class CouldNotMap : public std::exception {
+   public:
+
+    CouldNotMap() {
+      msg =  "MappedFileExce: CouldNotMap\nThe file could not be mapped!\n";
+    }
+
+    CouldNotMap(const std::string &s) {
+      msg =  "MappedFileExce: CouldNotMap\n"
+      "The file could not be mapped!\n" + s + '\n';
+    }
+
+    ~CouldNotMap() throw() {
+    }
+
+    const char* what() const throw() {
+      return msg.c_str();
+    }
+
+   private:
+    std::string msg;
+  };
+}
+
+/**
+ * The MappedFile class maps a file in to the address space. The kernel pages
+ * the memory in from the file and writes it back, so a mapping may be larger
+ * than the RAM - only the pages that were touched lately are resident.
+ *
+ * A file can be mapped read only to parse it without copying it in to a
+ * buffer first. A scratch mapping is backed by a new file in a directory that
+ * is removed at once; it lives until the mapping is destroyed and starts zero
+ * filled.
+ *
+ * advise() passes access hints for a byte range to the kernel. DONT_NEED drops
+ * the pages of the range from the resident set - the mapping is shared, so the
+ * data stays in the file and a page that is used again is read back in.
+ */
+class MappedFile {
+ public:
+  enum Advice { NORMAL, SEQUENTIAL, RANDOM, WILL_NEED, DONT_NEED };
+
+  // maps the file read only
+  explicit MappedFile(const std::string &filename);
+
+  // maps a new scratch file of size bytes in the directory
+  MappedFile(const std::string &directory, const std::size_t &size);
+
+  // unmaps and closes the file
+  ~MappedFile();
+
+  // returns the mapped bytes - the ones of a read only mapping must not be
+  // written
+  inline char *get_data() const {
+    return data_;
+  }
+
+  inline std::size_t get_size() const {
+    return size_;
+  }
+
+  // passes the advice for the bytes [offset, offset + length) to the kernel -
+  // the range is widened to whole pages, a failing hint is ignored
+  void advise(const std::size_t &offset,
+              const std::size_t &length,
+              const Advice &advice) const;
+
+  // returns the size of a page in byte
+  static std::size_t get_page_size();
+
+ private:
+  MappedFile(const MappedFile &);
+  MappedFile &operator=(const MappedFile &);
+
+  char *data_;
+  std::size_t size_;
+  int fd_;
+};
+
+/**
+ * Tag for the constructors of Matrix and Image that store the cells in a
+ * scratch MappedFile in directory instead of the heap.
+ */
+struct FileBacked {
+  explicit FileBacked(const std::string &dir = "/tmp") : directory(dir) {
+  }
+
+  std::string directory;
+};
+#endif
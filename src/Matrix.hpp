@@ -1,117 +1,100 @@
 #ifndef MATRIX_HPP
 #define MATRIX_HPP
 #include <stdlib.h>
-#include <vector>
+#include <new>
 #include <sstream>
 #include <stdexcept>
+#include <type_traits>
 
-
-namespace MatrixExce{
-  class DimensionsNotIdentical : public std::exception {
-   public:
-
-    DimensionsNotIdentical() {
-      msg =  "MatrixExce: DimensionsNotIdentical\nDimensions did not agree.\n";
-    }
-
-    template <typename TL, typename TR>
-    DimensionsNotIdentical(TL &l, TR &r) {
-      std::ostringstream ss;
-
-      ss  << "MatrixExce:\nDimensions did not agree.\n"
-      << "LHS: row: " << l.get_row_length()
-      << "\tcol: " << l.get_col_length()
-      << "\nRHS: row: " << r.get_row_length()
-      << "\tcol: " << r.get_col_length()
-      << '\n';
-
-      msg = ss.str();
-    }
-
-    ~DimensionsNotIdentical() throw() {
-    }
-
-    const char* what() const throw() {
-      return msg.c_str();
-    }
-
-   private:
-    std::string msg;
-  };
-
-  class MatrixNotEmpty : public std::exception {
-   public:
-    MatrixNotEmpty(std::string s = "") {
-      msg = "MatrixExce: DimensionsNotIdentical\n"
-      "Matrix has to be resized down with flag!\n" + s + '\n';
-    }
-
-    ~MatrixNotEmpty() throw() {
-    }
-
-    const char* what() const throw() {
-      return msg.c_str();
-    }
-
-   private:
-    std::string msg;
-  };
-}
+#include "Gemm.hpp"
+#include "MappedFile.hpp"
+#include "MatrixExpr.hpp"
+#include "MatrixView.hpp"
 
 /**
  * The Matrix class is en equivalent of a mathematical Matrix
+ *
+ * The cells are stored row-major in one aligned buffer. Every row starts on an
+ * ALIGNMENT boundary (if the size of T allows it), so the distance between two
+ * rows is get_stride() and not get_col_length().
+ *
+ * A matrix of an arithmetic type can keep its buffer in a scratch MappedFile
+ * instead of the heap (see FileBacked), so it may be larger than the RAM.
+ * advise() passes access hints for a range of rows to the kernel - a loop over
+ * a file backed matrix drops the rows it is done with to bound the resident
+ * set. Copies of a file backed matrix are stored on the heap.
  */
-template <typename T> class Matrix {
-  typedef std::vector<std::vector<T> > Vector2D;
-
+template <typename T> class Matrix : public MatrixExpr<Matrix<T> > {
  public:
-  //Default Constructor 1 x 1
+  typedef T value_type;
+  static constexpr unsigned int ROWS = 0;
+  static constexpr unsigned int COLS = 0;
+  static constexpr bool IS_LEAF = true;
+  static constexpr bool IS_DIRECT = true;
+  static constexpr bool IS_LOCAL = true;
+
+  // alignment in byte of the buffer and of every row in it
+  static const unsigned int ALIGNMENT = 64;
+
+  //Default Constructor 0 x 0
   Matrix() {
-    data_ = new Vector2D(0, std::vector<T>(0));
+    init();
   }
 
   //Specific Size Constructor m x m
   Matrix(const unsigned int &m) {
-    data_ = new Vector2D(m, std::vector<T>(m));
+    init();
+    allocate(m, m, T());
   }
 
   //Specific Size Constructor m x n
   Matrix(const unsigned int &m, const unsigned int &n, const T &val = T()) {
-    data_ = new Vector2D(m, std::vector<T>(n));
+    init();
+    allocate(m, n, val);
+  }
 
-    for(unsigned int i = 0; i < m; ++i) {
-      for(int j = 0; j < n; ++j) {
-        data_->at(i).at(j) = val;
-      }
-    }
+  // Constructor m x n with the cells stored in a scratch file - all cells are 0
+  Matrix(const unsigned int &m,
+         const unsigned int &n,
+         const FileBacked &backing) {
+    init();
+    allocate_mapped(m, n, backing.directory);
   }
+
   // copy constructor
   Matrix(const Matrix<T> &copy) {
-   data_ = new Vector2D(copy.get_row_length(),
-                        std::vector<T>(copy.get_col_length()));
+    init();
+    assign(copy);
+  }
+
+  // move constructor - takes over the buffer of other, other will be empty
+  Matrix(Matrix<T> &&other) noexcept {
+    init();
+    swap(other);
+  }
 
-   for(unsigned int i = 0; i < copy.get_row_length(); ++i) {
-     for(unsigned int j = 0; j < copy.get_col_length(); ++j) {
-       data_->at(i).at(j) = copy.get_data(i, j);
-     }
-   }
+  // evaluates the matrix expression in to a new matrix
+  template <typename E>
+  Matrix(const MatrixExpr<E> &expr) {
+    init();
+    evaluate(expr.self());
+  }
+
+  // calculates the matrix product in to a new matrix
+  template <typename L, typename R>
+  Matrix(const MatrixProductExpr<L, R> &expr) {
+    init();
+    multiply(expr);
   }
 
   //Destructor
   ~Matrix() {
-    delete data_;
+    release();
   }
 
-  // returns the matrix transposed
-  Matrix<T> transpose() const {
-    Matrix<T> ret = Matrix(data_->at(0).size(), data_->size());
-
-    for(unsigned int i = 0; i < ret.get_row_length(); i++) {
-      for(unsigned int j = 0; j < ret.get_col_length(); j++) {
-        ret.set_data(i, j, data_->at(j).at(i));
-      }
-    }
-    return ret;
+  // returns the matrix transposed - the cells are not copied
+  inline MatrixTransposeExpr<Matrix<T> > transpose() const {
+    return MatrixTransposeExpr<Matrix<T> >(*this);
   }
 
   //Adjusts the size of the matrix
@@ -123,13 +106,20 @@ template <typename T> class Matrix {
     if( ignore_size == true
         || (m >= get_row_length() && n >= get_col_length()) ) {
 
-      if(m != get_row_length()) {
-        data_->resize(m, std::vector<T>(n));
-      }
-      if(n != get_col_length()) {
-        for(unsigned int i = 0; i < m; i++) {
-          data_->at(i).resize(n, val);
+      if(m != get_row_length() || n != get_col_length()) {
+        Matrix<T> resized = Matrix<T>(m, n, val);
+        unsigned int keep_rows = (m < rows_) ? m : rows_;
+        unsigned int keep_cols = (n < cols_) ? n : cols_;
+
+        for(unsigned int i = 0; i < keep_rows; i++) {
+          const T *src = get_row(i);
+          T *dst = resized.get_row(i);
+
+          for(unsigned int j = 0; j < keep_cols; j++) {
+            dst[j] = src[j];
+          }
         }
+        swap(resized);
       }
     } else {
        throw MatrixExce::MatrixNotEmpty();
@@ -138,10 +128,10 @@ template <typename T> class Matrix {
 
   // sets the data at the position
   void set_data(const long &pos, const T data) {
-    unsigned int row = pos / get_col_length();
-    unsigned int col = pos % get_col_length();
+    unsigned int row = (cols_ == 0) ? 0 : pos / cols_;
+    unsigned int col = (cols_ == 0) ? 0 : pos % cols_;
 
-    if(row >= get_row_length() || col >= get_col_length()) {
+    if(pos < 0 || row >= get_row_length() || col >= get_col_length()) {
       std::ostringstream ss;
       ss << "There was an attempt to set data in a Matrix via 'set_data(const T"
       << "&data, const long &pos)' with a bad position: Pos: " << pos 
@@ -150,7 +140,7 @@ template <typename T> class Matrix {
       throw std::range_error(ss.str());
     }
 
-    data_->at(row).at(col) = data;
+    (*this)(row, col) = data;
   }
 
 
@@ -158,30 +148,121 @@ template <typename T> class Matrix {
   inline void set_data( const unsigned int &m,
                         const unsigned int &n,
                         const T &data) {
-    data_->at(m).at(n) = data;
+    check_position(m, n);
+    (*this)(m, n) = data;
+  }
+
+  // returns true if the cells are stored in a scratch file
+  inline bool is_file_backed() const {
+    return file_ != NULL;
+  }
+
+  // passes the advice for the rows [begin, end) to the kernel - does nothing
+  // if the matrix is not file backed
+  inline void advise(const unsigned int &begin,
+                     const unsigned int &end,
+                     const MappedFile::Advice &advice) const {
+    if(file_ != NULL && begin < end) {
+      std::size_t row = (std::size_t)stride_ * sizeof(T);
+      file_->advise(begin * row, (end - begin) * row, advice);
+    }
+  }
+
+  // returns the raw buffer, the rows are get_stride() cells apart
+  inline T *get_raw() {
+    return data_;
+  }
+
+  // returns the raw buffer, the rows are get_stride() cells apart
+  inline const T *get_raw() const {
+    return data_;
+  }
+
+  // returns a pointer to the first cell of the row m - unchecked
+  inline T *get_row(const unsigned int &m) {
+    return data_ + (std::size_t)m * stride_;
+  }
+
+  // returns a pointer to the first cell of the row m - unchecked
+  inline const T *get_row(const unsigned int &m) const {
+    return data_ + (std::size_t)m * stride_;
+  }
+
+  // returns the cell at m, n - unchecked, meant for hot loops
+  inline T &operator()(const unsigned int &m, const unsigned int &n) {
+    return data_[(std::size_t)m * stride_ + n];
   }
 
-  // returns the raw matrix / the vectors
-  inline Vector2D get_raw() const {
-    return *data_;
+  // returns the cell at m, n - unchecked, meant for hot loops
+  inline const T &operator()(const unsigned int &m,
+                             const unsigned int &n) const {
+    return data_[(std::size_t)m * stride_ + n];
+  }
+
+  // returns a view of rows x cols cells starting at row, col - the cells that
+  // reach over the edges of the matrix are read from the padding policy
+  template <typename Padding>
+  MatrixView<T, Padding> get_view(const unsigned int &row,
+                                  const unsigned int &col,
+                                  const unsigned int &rows,
+                                  const unsigned int &cols,
+                                  const Padding &padding) {
+    check_position(row, col);
+    return MatrixView<T, Padding>(get_row(row) + col, stride_, rows, cols,
+                                  rows_ - row, cols_ - col, padding);
+  }
+
+  // returns a read only view of rows x cols cells starting at row, col - the
+  // cells that reach over the edges of the matrix are read from the padding
+  // policy
+  template <typename Padding>
+  MatrixView<const T, Padding> get_view(const unsigned int &row,
+                                        const unsigned int &col,
+                                        const unsigned int &rows,
+                                        const unsigned int &cols,
+                                        const Padding &padding) const {
+    check_position(row, col);
+    return MatrixView<const T, Padding>(get_row(row) + col, stride_, rows, cols,
+                                        rows_ - row, cols_ - col, padding);
+  }
+
+  // returns a view of rows x cols cells starting at row, col - the cells that
+  // reach over the edges of the matrix are T()
+  inline MatrixView<T> get_view(const unsigned int &row,
+                                const unsigned int &col,
+                                const unsigned int &rows,
+                                const unsigned int &cols) {
+    return get_view(row, col, rows, cols, ZeroPadding());
+  }
+
+  // returns a read only view of rows x cols cells starting at row, col - the
+  // cells that reach over the edges of the matrix are T()
+  inline MatrixView<const T> get_view(const unsigned int &row,
+                                      const unsigned int &col,
+                                      const unsigned int &rows,
+                                      const unsigned int &cols) const {
+    return get_view(row, col, rows, cols, ZeroPadding());
   }
 
   //returns the data at m, n
   inline T get_data(const unsigned int &m, const unsigned int &n) const {
-    return data_->at(m).at(n);
+    check_position(m, n);
+    return (*this)(m, n);
   }
 
   //returns the length of the rows
   inline unsigned int get_row_length()  const {
-    return data_->size();
+    return rows_;
   }
 
   //returns the length of the columns
   inline unsigned int get_col_length() const {
-    if(data_->size() == 0) {
-      return 0;
-    }
-    return data_->at(0).size();
+    return cols_;
+  }
+
+  //returns the distance between two rows in cells
+  inline unsigned int get_stride() const {
+    return stride_;
   }
 
   // transforms the matrix to a sting readable for a human
@@ -190,7 +271,7 @@ template <typename T> class Matrix {
 
     for(unsigned int i = 0; i < get_row_length(); i++) {
       for(unsigned int j = 0; j < get_col_length(); j++) {
-       ss  << get_data(i, j) << ' ';
+       ss  << (*this)(i, j) << ' ';
       }
       ss << '\n';
     }
@@ -199,16 +280,23 @@ template <typename T> class Matrix {
     return ss.str();
   }
 
-  // returns the total value of all cells
+  // returns the total value of all cells - large matrices are summed up in
+  // parallel bands of rows that are added in order
   inline T get_total_value() const {
-    T res;
+    return MatrixExprDetail::reduce_bands<T>(rows_, cols_,
+        [this](unsigned int begin, unsigned int end) {
+          T res = T();
 
-    for(unsigned int i = 0; i < get_row_length(); i++) {
-      for(unsigned int j = 0; j < get_col_length(); j++) {
-        res += get_data(i, j);
-      }
-    }
-    return res;
+          for(unsigned int i = begin; i < end; i++) {
+            const T *row = get_row(i);
+
+            for(unsigned int j = 0; j < cols_; j++) {
+              res += row[j];
+            }
+          }
+          return res;
+        },
+        [](T &res, const T &partial) { res += partial; });
   }
 
   // returns a Matrix with the expo of each cell
@@ -220,275 +308,463 @@ template <typename T> class Matrix {
 
   // calculates the power of each cell
   void pow(const int &expo) {
-    if(expo != 0) {
-      T res;  
-      int conv_exp = (expo < 0) ? -expo : expo;
-      
-      for(unsigned int i = 0; i < get_row_length(); i++) {
-        for(unsigned int j = 0; j < get_col_length(); j++) {
-          res = get_data(i, j);
-
-          for(int k = conv_exp; k > 1; --k) {
-            res *= get_data(i, j);
+    MatrixExprDetail::for_each_band(rows_, cols_,
+        [this, expo](unsigned int begin, unsigned int end) {
+          if(expo != 0) {
+            T res;
+            int conv_exp = (expo < 0) ? -expo : expo;
+
+            for(unsigned int i = begin; i < end; i++) {
+              T *row = get_row(i);
+
+              for(unsigned int j = 0; j < cols_; j++) {
+                res = row[j];
+
+                for(int k = conv_exp; k > 1; --k) {
+                  res *= row[j];
+                }
+
+                if(expo < 0) {
+                  res = 1 / res;
+                }
+                row[j] = res;
+              }
+            }
+          } else {
+            for(unsigned int i = begin; i < end; i++) {
+              T *row = get_row(i);
+
+              for(unsigned int j = 0; j < cols_; j++) {
+                row[j] = row[j] * 0 + 1;
+              }
+            }
           }
-
-          if(expo < 0) {
-            res = 1 / res;
-          }
-          set_data(i, j, res);
-        }
-      }
-    } else {
-      for(unsigned int i = 0; i < get_row_length(); i++) {
-        for(unsigned int j = 0; j < get_col_length(); j++) {
-          set_data(i, j, get_data(i, j) * 0 + 1);
-        }
-      }
-    }
+        });
   }
 
   // returns the minimal cell
   T get_min() const {
-    unsigned int j = 1;
-    T res = get_data(0, 0);
-
-    for(unsigned int i = 0; i < get_row_length(); i++) {
-      for(;j < get_col_length(); j++) {
-        if(res > get_data(i, j)) {
-          res = get_data(i, j);
-        }
-      }
-      j = 0;
-    }
-
-    return res;
+    check_position(0, 0);
+
+    return MatrixExprDetail::reduce_bands<T>(rows_, cols_,
+        [this](unsigned int begin, unsigned int end) {
+          unsigned int j = 1;
+          T res = get_row(begin)[0];
+
+          for(unsigned int i = begin; i < end; i++) {
+            const T *row = get_row(i);
+
+            for(; j < cols_; j++) {
+              if(res > row[j]) {
+                res = row[j];
+              }
+            }
+            j = 0;
+          }
+          return res;
+        },
+        [](T &res, const T &partial) {
+          if(res > partial) {
+            res = partial;
+          }
+        });
   }
 
   // returns the maximal cell
   T get_max() const {
-    unsigned int j = 1;
-    T res = get_data(0, 0);
-
-    for(unsigned int i = 0; i < get_row_length(); i++) {
-      for(; j < get_col_length(); j++) {
-        if(res < get_data(i, j)) {
-          res = get_data(i, j);
-        }
-      }
-      j = 0;
-    }
+    check_position(0, 0);
+
+    return MatrixExprDetail::reduce_bands<T>(rows_, cols_,
+        [this](unsigned int begin, unsigned int end) {
+          unsigned int j = 1;
+          T res = get_row(begin)[0];
+
+          for(unsigned int i = begin; i < end; i++) {
+            const T *row = get_row(i);
+
+            for(; j < cols_; j++) {
+              if(res < row[j]) {
+                res = row[j];
+              }
+            }
+            j = 0;
+          }
+          return res;
+        },
+        [](T &res, const T &partial) {
+          if(res < partial) {
+            res = partial;
+          }
+        });
+  }
 
-    return res;
+  template <typename E>
+  Matrix<T> &operator+=(const MatrixExpr<E> &rhs) {
+    return update<MatrixExprDetail::Add>(rhs.self());
   }
 
   template <typename TParam>
-  const Matrix<T> operator+=(const Matrix<TParam> &rhs) {
-    if( get_row_length() == rhs.get_row_length()
-        && get_col_length() == rhs.get_col_length()) {
-
-      for(unsigned int i = 0; i < get_row_length(); i++) {
-        for(unsigned int j = 0; j < get_col_length(); j++) {
-          set_data(i, j, (get_data(i, j) + rhs.get_data(i, j)));
-        }
-      }
-      return *this;
-    } else if(get_row_length() == 0) {
-      Vector2D *temp = data_;
-      data_ = new Vector2D( rhs.get_row_length(),
-                            std::vector<T>(rhs.get_col_length()));      
-      for(unsigned int i = 0; i < rhs.get_row_length(); ++i) {
-        for(unsigned int j = 0; j < rhs.get_col_length(); ++j) {
-          data_->at(i).at(j) = rhs.get_data(i, j);
-        }
-      }
-      delete temp;
-    }
-    throw MatrixExce::DimensionsNotIdentical(*this, rhs);
+  typename std::enable_if<!IsMatrixExpr<TParam>::value, Matrix<T> &>::type
+  operator+=(const TParam &rhs) {
+    MatrixExprDetail::for_each_band(rows_, cols_,
+        [this, &rhs](unsigned int begin, unsigned int end) {
+          for(unsigned int i = begin; i < end; i++) {
+            T *row = get_row(i);
+
+            for(unsigned int j = 0; j < cols_; j++) {
+              row[j] += rhs;
+            }
+          }
+        });
+    return *this;
   }
 
-  template <typename TParam>
-  friend Matrix<T> operator+(Matrix<T> lhs, const Matrix<TParam> &rhs) {
-    lhs += rhs;
-    return lhs;
+  template <typename E>
+  Matrix<T> &operator-=(const MatrixExpr<E> &rhs) {
+    return update<MatrixExprDetail::Sub>(rhs.self());
   }
 
   template <typename TParam>
-  const Matrix<T> operator+=(const TParam &rhs) {
-   for(unsigned int i = 0; i < get_row_length(); i++) {
-      for(unsigned int j = 0; j < get_col_length(); j++) {
-        set_data(i, j, get_data(i, j) + rhs);
-      }
-    }
+  typename std::enable_if<!IsMatrixExpr<TParam>::value, Matrix<T> &>::type
+  operator-=(const TParam &rhs) {
+    MatrixExprDetail::for_each_band(rows_, cols_,
+        [this, &rhs](unsigned int begin, unsigned int end) {
+          for(unsigned int i = begin; i < end; i++) {
+            T *row = get_row(i);
+
+            for(unsigned int j = 0; j < cols_; j++) {
+              row[j] -= rhs;
+            }
+          }
+        });
     return *this;
   }
 
-  template <typename TParam>
-  friend Matrix<T> operator+(Matrix<T> lhs, const TParam& rhs) {
-    lhs += rhs;
-    return lhs;
+  template <typename E>
+  Matrix<T> &operator*=(const MatrixExpr<E> &rhs) {
+    return *this = *this * rhs.self();
   }
 
+  //Operator overloading for multiplication
   template <typename TParam>
-  const Matrix<T> operator-=(const Matrix<TParam> &rhs) {
-    if(get_row_length() == rhs.get_row_length()
-      && get_col_length() == rhs.get_col_length()) {
+  typename std::enable_if<!IsMatrixExpr<TParam>::value, Matrix<T> &>::type
+  operator*=(const TParam &multiplier) {
+    MatrixExprDetail::for_each_band(rows_, cols_,
+        [this, &multiplier](unsigned int begin, unsigned int end) {
+          for(unsigned int i = begin; i < end; i++) {
+            T *row = get_row(i);
+
+            for(unsigned int j = 0; j < cols_; j++) {
+              row[j] = row[j] * multiplier;
+            }
+          }
+        });
+    return *this;
+  }
 
-      for(unsigned int i = 0; i < get_row_length(); i++) {
-        for(unsigned int j = 0; j < get_col_length(); j++) {
-          set_data(i, j, (get_data(i, j) - rhs.get_data(i, j)));
-        }
-      }
-      return *this;
-    } else if(get_row_length() == 0) {
-     Vector2D *temp = data_;
+  template <typename E>
+  Matrix<T> &operator/=(const MatrixExpr<E> &rhs) {
+    return update<MatrixExprDetail::Div>(rhs.self());
+  }
 
-      data_ = new Vector2D( rhs.get_row_length(),
-                            std::vector<T>(rhs.get_col_length()));
-      for(unsigned int i = 0; i < rhs.get_row_length(); ++i) {
-        for(unsigned int j = 0; j < rhs.get_col_length(); ++j) {
-          data_->at(i).at(j) = rhs.get_data(i, j);
-        }
-      }
-      delete temp;
+  template <typename TParam>
+  typename std::enable_if<!IsMatrixExpr<TParam>::value, Matrix<T> &>::type
+  operator/=(const TParam &rhs) {
+    MatrixExprDetail::for_each_band(rows_, cols_,
+        [this, &rhs](unsigned int begin, unsigned int end) {
+          for(unsigned int i = begin; i < end; i++) {
+            T *row = get_row(i);
+
+            for(unsigned int j = 0; j < cols_; j++) {
+              row[j] = row[j] / rhs;
+            }
+          }
+        });
+    return *this;
+  }
+  
+  Matrix<T> &operator=(const Matrix<T> &rhs) {
+    if(this != &rhs) {
+      assign(rhs);
     }
-    throw MatrixExce::DimensionsNotIdentical(*this, rhs);
+    return *this;
   }
 
-  template <typename TParam>
-  friend Matrix<T> operator-(Matrix<T> lhs, const Matrix<TParam> &rhs) {
-    lhs -= rhs;
-    return lhs;
+  // move assignment - takes over the buffer of rhs, rhs will be empty
+  Matrix<T> &operator=(Matrix<T> &&rhs) noexcept {
+    if(this != &rhs) {
+      release();
+      swap(rhs);
+    }
+    return *this;
   }
 
-  template <typename TParam>
-  const Matrix<T> operator-=(const TParam &rhs) {
-   for(unsigned int i = 0; i < get_row_length(); i++) {
-      for(unsigned int j = 0; j < get_col_length(); j++) {
-        set_data(i, j, get_data(i, j) - rhs);
-      }
+  // evaluates the matrix expression in to the matrix
+  template <typename E>
+  Matrix<T> &operator=(const MatrixExpr<E> &expr) {
+    if(E::IS_LOCAL) {
+      evaluate(expr.self());
+    } else {
+      Matrix<T> result = Matrix<T>(expr);
+      swap(result);
     }
     return *this;
   }
 
-  template <typename TParam>
-  friend Matrix<T> operator-(Matrix<T> lhs, const TParam& rhs) {
-    lhs -= rhs;
-    return lhs;
+  // calculates the matrix product in to the matrix
+  template <typename L, typename R>
+  Matrix<T> &operator=(const MatrixProductExpr<L, R> &expr) {
+    Matrix<T> result = Matrix<T>(expr);
+    swap(result);
+    return *this;
   }
 
+  // exchanges the content of the two matrices without copying any cell
+  void swap(Matrix<T> &other) noexcept {
+    T *data = data_;
+    unsigned int rows = rows_;
+    unsigned int cols = cols_;
+    unsigned int stride = stride_;
+    MappedFile *file = file_;
+
+    data_ = other.data_;
+    rows_ = other.rows_;
+    cols_ = other.cols_;
+    stride_ = other.stride_;
+    file_ = other.file_;
+
+    other.data_ = data;
+    other.rows_ = rows;
+    other.cols_ = cols;
+    other.stride_ = stride;
+    other.file_ = file;
+  }
+
+ protected:
+  // sets the members to an empty matrix
+  inline void init() {
+    data_ = NULL;
+    rows_ = 0;
+    cols_ = 0;
+    stride_ = 0;
+    file_ = NULL;
+  }
+
+  // returns the stride for rows with n cells, so each row stays aligned
+  static unsigned int calculate_stride(const unsigned int &n) {
+    if(sizeof(T) > ALIGNMENT || ALIGNMENT % sizeof(T) != 0) {
+      return n;
+    }
+    unsigned int per_line = ALIGNMENT / sizeof(T);
+
+    return (n + per_line - 1) / per_line * per_line;
+  }
+
+  // replaces the buffer with a new m x n buffer with all cells set to val
+  void allocate(const unsigned int &m, const unsigned int &n, const T &val) {
+    unsigned int stride = calculate_stride(n);
+    std::size_t cells = (std::size_t)m * stride;
+    void *memory = NULL;
+
+    if(cells != 0
+       && posix_memalign(&memory, ALIGNMENT, cells * sizeof(T)) != 0) {
+      throw std::bad_alloc();
+    }
+
+    T *data = static_cast<T *>(memory);
+    std::size_t constructed = 0;
+
+    try {
+      for(; constructed < cells; ++constructed) {
+        new (data + constructed) T(val);
+      }
+    } catch(...) {
+      destroy(data, constructed);
+      throw;
+    }
+
+    release();
+    data_ = data;
+    rows_ = m;
+    cols_ = n;
+    stride_ = stride;
+  }
+
+  // replaces the buffer with a new m x n buffer in a scratch file in the
+  // directory - a new file reads as zeros, so no cell has to be touched
+  void allocate_mapped(const unsigned int &m,
+                       const unsigned int &n,
+                       const std::string &directory) {
+    static_assert(std::is_arithmetic<T>::value,
+                  "Only matrices of arithmetic types can be file backed");
+    unsigned int stride = calculate_stride(n);
+    MappedFile *file = new MappedFile(directory,
+                                      (std::size_t)m * stride * sizeof(T));
+
+    release();
+    file_ = file;
+    data_ = reinterpret_cast<T *>(file->get_data());
+    rows_ = m;
+    cols_ = n;
+    stride_ = stride;
+  }
+
+  // copies the size and all cells of rhs in to the matrix
   template <typename TParam>
-  const Matrix<T> operator*=(const Matrix<TParam> &rhs) {
-    if(get_col_length() == rhs.get_row_length()) {
-      T res;
-      Vector2D *temp = data_;
-      data_ = new Vector2D( get_row_length(),
-                            std::vector<T>(rhs.get_col_length())); 
-
-      for(unsigned int i = 0; i < get_row_length(); i++) {
-        for(unsigned int j = 0; j < rhs.get_col_length(); j++) {
-          res = T();
-          for(unsigned int k = 0; k < get_col_length(); k++) {
-            res += temp->at(i).at(k) * rhs.get_data(k, j);
-          }
-          data_->at(i).at(j) = res;
-        }
+  void assign(const Matrix<TParam> &rhs) {
+    if(rows_ != rhs.get_row_length() || cols_ != rhs.get_col_length()) {
+      allocate(rhs.get_row_length(), rhs.get_col_length(), T());
+    }
+
+    for(unsigned int i = 0; i < rows_; ++i) {
+      T *row = get_row(i);
+      const TParam *rhs_row = rhs.get_row(i);
+
+      for(unsigned int j = 0; j < cols_; ++j) {
+        row[j] = rhs_row[j];
       }
+    }
+  }
 
-      delete temp;
-      return *this;
+  // calculates all cells of the expression in to the matrix - the expression
+  // must not read cells of the matrix other than the one being written
+  template <typename E>
+  void evaluate(const E &expr) {
+    if(rows_ != expr.get_row_length() || cols_ != expr.get_col_length()) {
+      allocate(expr.get_row_length(), expr.get_col_length(), T());
     }
-    throw MatrixExce::DimensionsNotIdentical(*this, rhs);
+
+    MatrixExprDetail::for_each_band(rows_, cols_,
+        [this, &expr](unsigned int begin, unsigned int end) {
+          for(unsigned int i = begin; i < end; ++i) {
+            T *row = get_row(i);
+
+            for(unsigned int j = 0; j < cols_; ++j) {
+              row[j] = expr(i, j);
+            }
+          }
+        });
   }
 
-  template <typename TPara>
-  friend Matrix<T> operator*(Matrix<T> lhs, const Matrix<TPara> &rhs) {
-    lhs *= rhs;
-    return lhs;
+  // calculates the product - float and double products that are large enough
+  // are handed to the blocked kernel of Gemm
+  template <typename L, typename R>
+  void multiply(const MatrixProductExpr<L, R> &expr) {
+    multiply(expr, std::integral_constant<bool,
+        Gemm::IsSupported<T>::value
+        && std::is_same<T, typename L::value_type>::value>());
   }
 
-  //Operator overloading for multiplication
-  template <typename TParam>
-  const Matrix<T> operator*=(const TParam &multiplier) {
-    for(unsigned int i = 0; i < get_row_length(); i++) {
-      for(unsigned int j = 0; j < get_col_length(); j++) {
-        set_data(i, j, get_data(i, j) * multiplier);
-      }
+  template <typename L, typename R>
+  void multiply(const MatrixProductExpr<L, R> &expr, std::false_type) {
+    evaluate(expr);
+  }
+
+  template <typename L, typename R>
+  void multiply(const MatrixProductExpr<L, R> &expr, std::true_type) {
+    unsigned int m = expr.get_row_length();
+    unsigned int n = expr.get_col_length();
+    unsigned int k = expr.get_lhs().get_col_length();
+
+    if((std::size_t)m * n * k < Gemm::MIN_MULTIPLICATIONS) {
+      evaluate(expr);
+      return;
     }
-    return *this;
+    Matrix<T> lhs_buffer;
+    Matrix<T> rhs_buffer;
+    Gemm::Operand<T> lhs = get_operand(expr.get_lhs(), lhs_buffer);
+    Gemm::Operand<T> rhs = get_operand(expr.get_rhs(), rhs_buffer);
+
+    if(rows_ != m || cols_ != n) {
+      allocate(m, n, T());
+    }
+    Gemm::multiply(lhs, rhs, data_, stride_, m, n, k);
   }
 
-  template <typename TParam>
-  friend Matrix<T> operator*(Matrix<T> lhs, const TParam &rhs) {
-    lhs *= rhs;
-    return lhs;
+  // returns the cells of an operand of a product - operands that are neither
+  // a matrix nor a transposed matrix are evaluated in to the buffer
+  template <typename E>
+  static Gemm::Operand<T> get_operand(const E &expr, Matrix<T> &buffer) {
+    buffer = expr;
+    return get_operand(buffer, buffer);
   }
 
-  template <typename TParam>
-  const Matrix<T> operator/=(const Matrix<TParam> &rhs) {
+  static Gemm::Operand<T> get_operand(const Matrix<T> &matrix, Matrix<T> &) {
+    Gemm::Operand<T> operand = {matrix.data_, matrix.stride_, false};
+
+    return operand;
+  }
+
+  static Gemm::Operand<T> get_operand(
+      const MatrixTransposeExpr<Matrix<T> > &expr, Matrix<T> &buffer) {
+    Gemm::Operand<T> operand = get_operand(expr.get_expr(), buffer);
+
+    operand.transposed = true;
+    return operand;
+  }
+
+  // applies Op cell by cell with the cells of the expression on the matrix
+  // if the matrix is empty it becomes the expression
+  template <typename Op, typename E>
+  Matrix<T> &update(const E &rhs) {
+    if(!E::IS_LOCAL) {
+      return update<Op>(Matrix<typename E::value_type>(rhs));
+    }
+
     if( get_row_length() == rhs.get_row_length()
         && get_col_length() == rhs.get_col_length()) {
 
-      for(unsigned int i = 0; i < get_row_length(); i++) {
-        for(unsigned int j = 0; j < get_col_length(); j++) {
-          set_data(i, j, (get_data(i, j) / rhs.get_data(i, j)));
-        }
-      }
+      MatrixExprDetail::for_each_band(rows_, cols_,
+          [this, &rhs](unsigned int begin, unsigned int end) {
+            for(unsigned int i = begin; i < end; i++) {
+              T *row = get_row(i);
+
+              for(unsigned int j = 0; j < cols_; j++) {
+                Op::update(row[j], rhs(i, j));
+              }
+            }
+          });
       return *this;
     } else if(get_row_length() == 0) {
-      Vector2D *temp = data_;
-      data_ = new Vector2D( rhs.get_row_length(),
-                            std::vector<T>(rhs.get_col_length()));
-
-      for(unsigned int i = 0; i < rhs.get_row_length(); ++i) {
-        for(unsigned int j = 0; j < rhs.get_col_length(); ++j) {
-          data_->at(i).at(j) = rhs.get_data(i, j);
-        }
-      }
-      delete temp;
+      evaluate(rhs);
+      return *this;
     }
     throw MatrixExce::DimensionsNotIdentical(*this, rhs);
   }
 
-  template <typename TParam>
-  const inline friend Matrix<T> operator/(Matrix<T> lhs,
-                                          const Matrix<TParam> &rhs) {
-    lhs /= rhs;
-    return lhs;
-  }
-
-  template <typename TParam>
-  const Matrix<T> operator/=(const TParam &rhs) {
-   for(unsigned int i = 0; i < get_row_length(); i++) {
-      for(unsigned int j = 0; j < get_col_length(); j++) {
-        set_data(i, j, get_data(i, j) / rhs);
-      }
+  // destructs the cells and frees the buffer
+  inline void release() {
+    if(file_ != NULL) {
+      delete file_;
+    } else {
+      destroy(data_, (std::size_t)rows_ * stride_);
     }
-    return *this;
+    init();
   }
 
-  template <typename TParam>
-  inline friend Matrix<T> operator/(Matrix<T> lhs, const TParam& rhs) {
-    lhs /= rhs;
-    return lhs;
+  static void destroy(T *data, const std::size_t &cells) {
+    for(std::size_t i = 0; i < cells; ++i) {
+      data[i].~T();
+    }
+    free(data);
   }
-  
-  Matrix<T> operator=(const Matrix<T> &rhs) {
-    if(this != &rhs) {
-      Vector2D *temp = data_;
-      data_ = new  Vector2D(rhs.get_row_length(),
-                            std::vector<T>(rhs.get_col_length()));
 
-      for(unsigned int i = 0; i < rhs.get_row_length(); ++i) {
-        for(unsigned int j = 0; j < rhs.get_col_length(); ++j) {
-          data_->at(i).at(j) = rhs.get_data(i, j);
-        }
-      }
-      delete temp;
+  // throws if m, n is not a cell of the matrix
+  inline void check_position(const unsigned int &m,
+                             const unsigned int &n) const {
+    if(m >= rows_ || n >= cols_) {
+      std::ostringstream ss;
+      ss << "There was an attempt to access a Matrix at a bad position:"
+      << "\nRow: " << m << "\tCol: " << n << "\nThe size of the matrix was:"
+      << "\nRow: " << rows_ << "\tCol: " << cols_ << "\n";
+      throw std::out_of_range(ss.str());
     }
-    return *this;
   }
 
- protected:
-  Vector2D *data_;
+  T *data_;
+  unsigned int rows_;
+  unsigned int cols_;
+  unsigned int stride_;
+  MappedFile *file_;
 };
 #endif
@@ -0,0 +1,548 @@
+#ifndef MATRIX_EXPR_HPP
+#define MATRIX_EXPR_HPP
+
+#include <stdlib.h>
+#include <sstream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "ThreadPool.hpp"
+
+namespace MatrixExce{
+  class DimensionsNotIdentical : public std::exception {
+   public:
+
+    DimensionsNotIdentical() {
+      msg =  "MatrixExce: DimensionsNotIdentical\nDimensions did not agree.\n";
+    }
+
+    template <typename TL, typename TR>
+    DimensionsNotIdentical(TL &l, TR &r) {
+      std::ostringstream ss;
+
+      ss  << "MatrixExce:\nDimensions did not agree.\n"
+      << "LHS: row: " << l.get_row_length()
+      << "\tcol: " << l.get_col_length()
+      << "\nRHS: row: " << r.get_row_length()
+      << "\tcol: " << r.get_col_length()
+      << '\n';
+
+      msg = ss.str();
+    }
+
+    ~DimensionsNotIdentical() throw() {
+    }
+
+    const char* what() const throw() {
+      return msg.c_str();
+    }
+
+   private:
+    std::string msg;
+  };
+
+  class MatrixNotEmpty : public std::exception {
+   public:
+    MatrixNotEmpty(std::string s = "") {
+      msg = "MatrixExce: DimensionsNotIdentical\n"
+      "Matrix has to be resized down with flag!\n" + s + '\n';
+    }
+
+    ~MatrixNotEmpty() throw() {
+    }
+
+    const char* what() const throw() {
+      return msg.c_str();
+    }
+
+   private:
+    std::string msg;
+  };
+}
+
+template <typename T> class Matrix;
+template <typename T, unsigned int R, unsigned int C> class FixedMatrix;
+
+/**
+ * Calls f(0) ... f(N - 1). The recursion is resolved by the compiler, so the
+ * loop is fully unrolled.
+ */
+template <unsigned int N> struct FixedLoop {
+  template <typename F>
+  static inline void run(const F &f) {
+    FixedLoop<N - 1>::run(f);
+    f(N - 1);
+  }
+};
+
+template <> struct FixedLoop<0> {
+  template <typename F>
+  static inline void run(const F &) {
+  }
+};
+
+/**
+ * The MatrixExpr class is the base of Matrix, FixedMatrix and all lazy matrix
+ * expressions. An expression like (a - b) * 2 + c.transpose() only records its
+ * operands, the cells are calculated in a single loop once the expression is
+ * assigned to a Matrix or FixedMatrix. A transposed matrix is read with
+ * swapped indices instead of being copied.
+ *
+ * Every expression E provides:
+ *   value_type                the type of the cells
+ *   ROWS, COLS                the dimensions if known at compile time, else 0
+ *   IS_LEAF                   true if E stores its cells (Matrix, FixedMatrix)
+ *   IS_DIRECT                 true if the cells are read from a leaf without
+ *                             any calculation (leaf or transposed leaf)
+ *   IS_LOCAL                  true if cell m, n only depends on the cells m, n
+ *                             of the operands, so it can be assigned to one of
+ *                             its operands without a temporary
+ *   get_row_length(), get_col_length(), operator()(m, n)
+ */
+namespace MatrixExprDetail {
+  // cells a band of rows has at least before a matrix is split over threads
+  const std::size_t BAND_CELLS = 1 << 15;
+
+  // returns the amount of rows of a band - it only depends on the dimensions,
+  // so a reduction gives the same result with any amount of threads
+  inline unsigned int get_band_rows(const unsigned int &rows,
+                                    const unsigned int &cols) {
+    std::size_t band = (cols == 0) ? rows : BAND_CELLS / cols;
+
+    return (band == 0) ? 1 : (band > rows) ? rows : (unsigned int)band;
+  }
+
+  // calls func(begin, end) for the bands of rows - matrices with more than one
+  // band are split over the default ThreadPool
+  template <typename F>
+  inline void for_each_band(const unsigned int &rows,
+                            const unsigned int &cols,
+                            const F &func) {
+    ThreadPool::get_default().parallel_for(rows, get_band_rows(rows, cols),
+                                           func);
+  }
+
+  // reduces every band with reduce(begin, end) and combines the partials in
+  // the order of the bands with combine(result, partial)
+  template <typename T, typename F, typename C>
+  T reduce_bands(const unsigned int &rows,
+                 const unsigned int &cols,
+                 const F &reduce,
+                 const C &combine) {
+    unsigned int band = get_band_rows(rows, cols);
+
+    if(band >= rows) {
+      return reduce(0, rows);
+    }
+    std::vector<T> partials((rows + band - 1) / band);
+
+    for_each_band(rows, cols, [&partials, &reduce, band](unsigned int begin,
+                                                          unsigned int end) {
+      partials[begin / band] = reduce(begin, end);
+    });
+
+    T res = partials[0];
+
+    for(unsigned int i = 1; i < partials.size(); ++i) {
+      combine(res, partials[i]);
+    }
+    return res;
+  }
+}
+
+template <typename E> class MatrixExpr {
+ public:
+  // returns the expression as its real type
+  inline const E &self() const {
+    return static_cast<const E &>(*this);
+  }
+
+  // returns the total value of all cells - large expressions are summed up in
+  // parallel bands of rows
+  template <typename Self = E>
+  typename Self::value_type get_total_value() const {
+    typedef typename Self::value_type T;
+    const Self &e = self();
+
+    return MatrixExprDetail::reduce_bands<T>(
+        e.get_row_length(), e.get_col_length(),
+        [&e](unsigned int begin, unsigned int end) {
+          T res = T();
+
+          for(unsigned int i = begin; i < end; ++i) {
+            for(unsigned int j = 0; j < e.get_col_length(); ++j) {
+              res += e(i, j);
+            }
+          }
+          return res;
+        },
+        [](T &res, const T &partial) { res += partial; });
+  }
+};
+
+namespace MatrixExprDetail {
+  template <typename E>
+  std::true_type is_matrix_expr(const MatrixExpr<E> *);
+  std::false_type is_matrix_expr(...);
+
+  // chooses the container an expression is evaluated in to
+  template <typename T, unsigned int R, unsigned int C>
+  struct Eval {
+    typedef FixedMatrix<T, R, C> type;
+  };
+
+  template <typename T, unsigned int C>
+  struct Eval<T, 0, C> {
+    typedef Matrix<T> type;
+  };
+
+  template <typename T, unsigned int R>
+  struct Eval<T, R, 0> {
+    typedef Matrix<T> type;
+  };
+
+  template <typename T>
+  struct Eval<T, 0, 0> {
+    typedef Matrix<T> type;
+  };
+
+  // leafs are held by reference, expressions are small and held by value
+  template <typename E>
+  struct Storage {
+    typedef typename std::conditional<E::IS_LEAF, const E &, const E>::type
+        type;
+  };
+
+  // operands of a product are read many times - anything that has to be
+  // calculated is evaluated once up front
+  template <typename E>
+  struct ProductOperand {
+    typedef typename std::conditional<
+        E::IS_DIRECT,
+        typename Storage<E>::type,
+        const typename Eval<typename E::value_type, E::ROWS, E::COLS>::type
+      >::type type;
+  };
+
+  // the dimension of two operands that have to agree
+  template <unsigned int L, unsigned int R>
+  struct Dimension {
+    static_assert(L == 0 || R == 0 || L == R,
+                  "MatrixExpr: Dimensions did not agree");
+    static constexpr unsigned int value = (L != 0) ? L : R;
+  };
+
+  // the dot product of row m of lhs and column n of rhs
+  template <unsigned int N>
+  struct Dot {
+    template <typename T, typename L, typename R>
+    static inline T run(const L &lhs, const R &rhs,
+                        const unsigned int &m, const unsigned int &n) {
+      T res = T();
+
+      FixedLoop<N>::run([&res, &lhs, &rhs, m, n](unsigned int k) {
+        res += lhs(m, k) * rhs(k, n);
+      });
+      return res;
+    }
+  };
+
+  template <>
+  struct Dot<0> {
+    template <typename T, typename L, typename R>
+    static inline T run(const L &lhs, const R &rhs,
+                        const unsigned int &m, const unsigned int &n) {
+      T res = T();
+
+      for(unsigned int k = 0, k_end = lhs.get_col_length(); k < k_end; ++k) {
+        res += lhs(m, k) * rhs(k, n);
+      }
+      return res;
+    }
+  };
+
+  struct Add {
+    template <typename A, typename B>
+    static inline A apply(const A &a, const B &b) {
+      return a + b;
+    }
+
+    template <typename A, typename B>
+    static inline void update(A &a, const B &b) {
+      a += b;
+    }
+  };
+
+  struct Sub {
+    template <typename A, typename B>
+    static inline A apply(const A &a, const B &b) {
+      return a - b;
+    }
+
+    template <typename A, typename B>
+    static inline void update(A &a, const B &b) {
+      a -= b;
+    }
+  };
+
+  struct Mul {
+    template <typename A, typename B>
+    static inline A apply(const A &a, const B &b) {
+      return a * b;
+    }
+
+    template <typename A, typename B>
+    static inline void update(A &a, const B &b) {
+      a *= b;
+    }
+  };
+
+  struct Div {
+    template <typename A, typename B>
+    static inline A apply(const A &a, const B &b) {
+      return a / b;
+    }
+
+    template <typename A, typename B>
+    static inline void update(A &a, const B &b) {
+      a /= b;
+    }
+  };
+}
+
+// true if T is a Matrix, a FixedMatrix or a matrix expression
+template <typename T> struct IsMatrixExpr
+    : decltype(MatrixExprDetail::is_matrix_expr(static_cast<const T *>(NULL))) {
+};
+
+/**
+ * Cell by cell operation of two matrices with the same dimensions
+ */
+template <typename L, typename R, typename Op>
+class MatrixBinaryExpr : public MatrixExpr<MatrixBinaryExpr<L, R, Op> > {
+ public:
+  typedef typename L::value_type value_type;
+  static constexpr unsigned int ROWS =
+      MatrixExprDetail::Dimension<L::ROWS, R::ROWS>::value;
+  static constexpr unsigned int COLS =
+      MatrixExprDetail::Dimension<L::COLS, R::COLS>::value;
+  static constexpr bool IS_LEAF = false;
+  static constexpr bool IS_DIRECT = false;
+  static constexpr bool IS_LOCAL = L::IS_LOCAL && R::IS_LOCAL;
+
+  MatrixBinaryExpr(const L &lhs, const R &rhs) : lhs_(lhs), rhs_(rhs) {
+    if( lhs.get_row_length() != rhs.get_row_length()
+        || lhs.get_col_length() != rhs.get_col_length()) {
+      throw MatrixExce::DimensionsNotIdentical(lhs, rhs);
+    }
+  }
+
+  inline unsigned int get_row_length() const {
+    return lhs_.get_row_length();
+  }
+
+  inline unsigned int get_col_length() const {
+    return lhs_.get_col_length();
+  }
+
+  inline value_type operator()(const unsigned int &m,
+                               const unsigned int &n) const {
+    return Op::apply(value_type(lhs_(m, n)), rhs_(m, n));
+  }
+
+ private:
+  typename MatrixExprDetail::Storage<L>::type lhs_;
+  typename MatrixExprDetail::Storage<R>::type rhs_;
+};
+
+/**
+ * Operation of every cell of a matrix with a scalar
+ */
+template <typename E, typename S, typename Op>
+class MatrixScalarExpr : public MatrixExpr<MatrixScalarExpr<E, S, Op> > {
+ public:
+  typedef typename E::value_type value_type;
+  static constexpr unsigned int ROWS = E::ROWS;
+  static constexpr unsigned int COLS = E::COLS;
+  static constexpr bool IS_LEAF = false;
+  static constexpr bool IS_DIRECT = false;
+  static constexpr bool IS_LOCAL = E::IS_LOCAL;
+
+  MatrixScalarExpr(const E &expr, const S &scalar)
+      : expr_(expr), scalar_(scalar) {
+  }
+
+  inline unsigned int get_row_length() const {
+    return expr_.get_row_length();
+  }
+
+  inline unsigned int get_col_length() const {
+    return expr_.get_col_length();
+  }
+
+  inline value_type operator()(const unsigned int &m,
+                               const unsigned int &n) const {
+    return Op::apply(value_type(expr_(m, n)), scalar_);
+  }
+
+ private:
+  typename MatrixExprDetail::Storage<E>::type expr_;
+  const S scalar_;
+};
+
+/**
+ * The transposed matrix - the indices are swapped, nothing is copied
+ */
+template <typename E>
+class MatrixTransposeExpr : public MatrixExpr<MatrixTransposeExpr<E> > {
+ public:
+  typedef typename E::value_type value_type;
+  static constexpr unsigned int ROWS = E::COLS;
+  static constexpr unsigned int COLS = E::ROWS;
+  static constexpr bool IS_LEAF = false;
+  static constexpr bool IS_DIRECT = E::IS_DIRECT;
+  static constexpr bool IS_LOCAL = false;
+
+  explicit MatrixTransposeExpr(const E &expr) : expr_(expr) {
+  }
+
+  inline unsigned int get_row_length() const {
+    return expr_.get_col_length();
+  }
+
+  inline unsigned int get_col_length() const {
+    return expr_.get_row_length();
+  }
+
+  inline value_type operator()(const unsigned int &m,
+                               const unsigned int &n) const {
+    return expr_(n, m);
+  }
+
+  // returns the expression that is transposed
+  inline const E &get_expr() const {
+    return expr_;
+  }
+
+ private:
+  typename MatrixExprDetail::Storage<E>::type expr_;
+};
+
+/**
+ * The matrix product - the columns of lhs have to match the rows of rhs.
+ * Operands that are products or other calculations are evaluated once when
+ * the expression is created, leafs and transposed leafs are read in place.
+ */
+template <typename L, typename R>
+class MatrixProductExpr : public MatrixExpr<MatrixProductExpr<L, R> > {
+ public:
+  typedef typename L::value_type value_type;
+  static constexpr unsigned int ROWS = L::ROWS;
+  static constexpr unsigned int COLS = R::COLS;
+  static constexpr unsigned int INNER =
+      MatrixExprDetail::Dimension<L::COLS, R::ROWS>::value;
+  static constexpr bool IS_LEAF = false;
+  static constexpr bool IS_DIRECT = false;
+  static constexpr bool IS_LOCAL = false;
+
+  MatrixProductExpr(const L &lhs, const R &rhs) : lhs_(lhs), rhs_(rhs) {
+    if(lhs.get_col_length() != rhs.get_row_length()) {
+      throw MatrixExce::DimensionsNotIdentical(lhs, rhs);
+    }
+  }
+
+  inline unsigned int get_row_length() const {
+    return lhs_.get_row_length();
+  }
+
+  inline unsigned int get_col_length() const {
+    return rhs_.get_col_length();
+  }
+
+  inline value_type operator()(const unsigned int &m,
+                               const unsigned int &n) const {
+    return MatrixExprDetail::Dot<INNER>::template run<value_type>(lhs_, rhs_,
+                                                                  m, n);
+  }
+
+  inline const typename std::remove_reference<
+      typename MatrixExprDetail::ProductOperand<L>::type>::type &get_lhs() const {
+    return lhs_;
+  }
+
+  inline const typename std::remove_reference<
+      typename MatrixExprDetail::ProductOperand<R>::type>::type &get_rhs() const {
+    return rhs_;
+  }
+
+ private:
+  typename MatrixExprDetail::ProductOperand<L>::type lhs_;
+  typename MatrixExprDetail::ProductOperand<R>::type rhs_;
+};
+
+template <typename L, typename R>
+inline MatrixBinaryExpr<L, R, MatrixExprDetail::Add>
+operator+(const MatrixExpr<L> &lhs, const MatrixExpr<R> &rhs) {
+  return MatrixBinaryExpr<L, R, MatrixExprDetail::Add>(lhs.self(), rhs.self());
+}
+
+template <typename L, typename R>
+inline MatrixBinaryExpr<L, R, MatrixExprDetail::Sub>
+operator-(const MatrixExpr<L> &lhs, const MatrixExpr<R> &rhs) {
+  return MatrixBinaryExpr<L, R, MatrixExprDetail::Sub>(lhs.self(), rhs.self());
+}
+
+// divides the matrices cell by cell
+template <typename L, typename R>
+inline MatrixBinaryExpr<L, R, MatrixExprDetail::Div>
+operator/(const MatrixExpr<L> &lhs, const MatrixExpr<R> &rhs) {
+  return MatrixBinaryExpr<L, R, MatrixExprDetail::Div>(lhs.self(), rhs.self());
+}
+
+// multiplies the matrices cell by cell
+template <typename L, typename R>
+inline MatrixBinaryExpr<L, R, MatrixExprDetail::Mul>
+multiply_cells(const MatrixExpr<L> &lhs, const MatrixExpr<R> &rhs) {
+  return MatrixBinaryExpr<L, R, MatrixExprDetail::Mul>(lhs.self(), rhs.self());
+}
+
+// the matrix product
+template <typename L, typename R>
+inline MatrixProductExpr<L, R>
+operator*(const MatrixExpr<L> &lhs, const MatrixExpr<R> &rhs) {
+  return MatrixProductExpr<L, R>(lhs.self(), rhs.self());
+}
+
+template <typename E, typename S>
+inline typename std::enable_if<
+    !IsMatrixExpr<S>::value,
+    MatrixScalarExpr<E, S, MatrixExprDetail::Add> >::type
+operator+(const MatrixExpr<E> &lhs, const S &rhs) {
+  return MatrixScalarExpr<E, S, MatrixExprDetail::Add>(lhs.self(), rhs);
+}
+
+template <typename E, typename S>
+inline typename std::enable_if<
+    !IsMatrixExpr<S>::value,
+    MatrixScalarExpr<E, S, MatrixExprDetail::Sub> >::type
+operator-(const MatrixExpr<E> &lhs, const S &rhs) {
+  return MatrixScalarExpr<E, S, MatrixExprDetail::Sub>(lhs.self(), rhs);
+}
+
+template <typename E, typename S>
+inline typename std::enable_if<
+    !IsMatrixExpr<S>::value,
+    MatrixScalarExpr<E, S, MatrixExprDetail::Mul> >::type
+operator*(const MatrixExpr<E> &lhs, const S &rhs) {
+  return MatrixScalarExpr<E, S, MatrixExprDetail::Mul>(lhs.self(), rhs);
+}
+
+template <typename E, typename S>
+inline typename std::enable_if<
+    !IsMatrixExpr<S>::value,
+    MatrixScalarExpr<E, S, MatrixExprDetail::Div> >::type
+operator/(const MatrixExpr<E> &lhs, const S &rhs) {
+  return MatrixScalarExpr<E, S, MatrixExprDetail::Div>(lhs.self(), rhs);
+}
+#endif
@@ -0,0 +1,233 @@
+#ifndef MATRIX_VIEW_HPP
+#define MATRIX_VIEW_HPP
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include "MatrixExpr.hpp"
+
+///////////////////////////////////
+//       Padding policies        //
+///////////////////////////////////
+
+/**
+ * Cells outside of the viewed matrix are T()
+ */
+struct ZeroPadding {
+  template <typename V>
+  inline const typename V::value_type &get(const V &,
+                                           const unsigned int &,
+                                           const unsigned int &) const {
+    static const typename V::value_type zero = typename V::value_type();
+    return zero;
+  }
+};
+
+/**
+ * Cells outside of the viewed matrix repeat the closest cell at the edge - a
+ * window that lies completely outside of the matrix has no edge and reads T()
+ */
+struct EdgePadding {
+  template <typename V>
+  inline const typename V::value_type &get(const V &view,
+                                           const unsigned int &m,
+                                           const unsigned int &n) const {
+    unsigned int rows = view.get_valid_rows();
+    unsigned int cols = view.get_valid_cols();
+
+    if(rows == 0 || cols == 0) {
+      return ZeroPadding().get(view, m, n);
+    }
+    unsigned int row = (m < rows) ? m : rows - 1;
+    unsigned int col = (n < cols) ? n : cols - 1;
+
+    return view.get_row(row)[col];
+  }
+};
+
+/**
+ * Cells outside of the viewed matrix have a fixed value
+ */
+template <typename T> class ConstantPadding {
+ public:
+  explicit ConstantPadding(const T &value) : value_(value) {
+  }
+
+  template <typename V>
+  inline const typename V::value_type &get(const V &,
+                                           const unsigned int &,
+                                           const unsigned int &) const {
+    return value_;
+  }
+
+ private:
+  T value_;
+};
+
+/**
+ * The MatrixView class is a window of rows x cols cells in to the buffer of a
+ * Matrix - it does not own or copy any cell. The window starts inside of the
+ * matrix but may reach over its edges, e.g. the last 8x8 block of a picture
+ * that is not a multiple of 8. Cells outside of the matrix are read through the
+ * Padding policy and writes to them are dropped.
+ *
+ * A MatrixView<const T> is read only. Assigning a matrix expression to a
+ * MatrixView writes the cells in to the viewed matrix. Copying a MatrixView,
+ * also by assigning a MatrixView of the same type, only copies the window - the
+ * view is bound to the other window and no cell is written.
+ *
+ * Cell m, n of a view is not cell m, n of the matrix, so a view is no local
+ * expression - a view that overlaps the one it is assigned to is read in to a
+ * temporary first.
+ */
+template <typename T, typename Padding = ZeroPadding>
+class MatrixView : public MatrixExpr<MatrixView<T, Padding> > {
+ public:
+  typedef typename std::remove_const<T>::type value_type;
+  static constexpr unsigned int ROWS = 0;
+  static constexpr unsigned int COLS = 0;
+  static constexpr bool IS_LEAF = false;
+  static constexpr bool IS_DIRECT = true;
+  static constexpr bool IS_LOCAL = false;
+
+  /**
+   * @param data       the first cell of the window
+   * @param stride     the distance between two rows of the matrix in cells
+   * @param rows       the amount of rows of the window
+   * @param cols       the amount of columns of the window
+   * @param valid_rows the amount of rows of the window inside of the matrix
+   * @param valid_cols the amount of columns of the window inside of the matrix
+   * @param padding    the policy for cells outside of the matrix
+   */
+  MatrixView(T *data,
+             const unsigned int &stride,
+             const unsigned int &rows,
+             const unsigned int &cols,
+             const unsigned int &valid_rows,
+             const unsigned int &valid_cols,
+             const Padding &padding = Padding())
+      : data_(data),
+        stride_(stride),
+        rows_(rows),
+        cols_(cols),
+        valid_rows_((valid_rows < rows) ? valid_rows : rows),
+        valid_cols_((valid_cols < cols) ? valid_cols : cols),
+        padding_(padding) {
+  }
+
+  // evaluates the matrix expression in to the viewed cells - an expression
+  // that is not local may read cells that are written before, e.g. v =
+  // v.transpose(), so it is evaluated in to a temporary first
+  template <typename E>
+  MatrixView<T, Padding> &operator=(const MatrixExpr<E> &expr) {
+    const E &e = expr.self();
+
+    if(e.get_row_length() != rows_ || e.get_col_length() != cols_) {
+      throw MatrixExce::DimensionsNotIdentical(*this, e);
+    }
+
+    if(!E::IS_LOCAL) {
+      std::vector<value_type> cells((std::size_t)valid_rows_ * valid_cols_);
+
+      for(unsigned int i = 0; i < valid_rows_; ++i) {
+        for(unsigned int j = 0; j < valid_cols_; ++j) {
+          cells[(std::size_t)i * valid_cols_ + j] = e(i, j);
+        }
+      }
+      for(unsigned int i = 0; i < valid_rows_; ++i) {
+        std::copy(cells.begin() + (std::size_t)i * valid_cols_,
+                  cells.begin() + (std::size_t)(i + 1) * valid_cols_,
+                  get_row(i));
+      }
+      return *this;
+    }
+
+    for(unsigned int i = 0; i < valid_rows_; ++i) {
+      T *row = get_row(i);
+
+      for(unsigned int j = 0; j < valid_cols_; ++j) {
+        row[j] = e(i, j);
+      }
+    }
+    return *this;
+  }
+
+  //returns the length of the rows
+  inline unsigned int get_row_length() const {
+    return rows_;
+  }
+
+  //returns the length of the columns
+  inline unsigned int get_col_length() const {
+    return cols_;
+  }
+
+  // returns the amount of rows that are inside of the matrix
+  inline unsigned int get_valid_rows() const {
+    return valid_rows_;
+  }
+
+  // returns the amount of columns that are inside of the matrix
+  inline unsigned int get_valid_cols() const {
+    return valid_cols_;
+  }
+
+  //returns the distance between two rows in cells
+  inline unsigned int get_stride() const {
+    return stride_;
+  }
+
+  // returns true if no cell of the window is outside of the matrix
+  inline bool is_complete() const {
+    return valid_rows_ == rows_ && valid_cols_ == cols_;
+  }
+
+  // returns true if the cell m, n is inside of the matrix
+  inline bool contains(const unsigned int &m, const unsigned int &n) const {
+    return m < valid_rows_ && n < valid_cols_;
+  }
+
+  // returns a pointer to the first cell of the row m - unchecked, only the
+  // first get_valid_cols() cells belong to the matrix
+  inline T *get_row(const unsigned int &m) const {
+    return data_ + (std::size_t)m * stride_;
+  }
+
+  // returns the cell at m, n or the padding if it is outside of the matrix
+  inline const value_type &operator()(const unsigned int &m,
+                                      const unsigned int &n) const {
+    if(contains(m, n)) {
+      return get_row(m)[n];
+    }
+    return padding_.get(*this, m, n);
+  }
+
+  // returns the view transposed - the cells are not copied
+  inline MatrixTransposeExpr<MatrixView<T, Padding> > transpose() const {
+    return MatrixTransposeExpr<MatrixView<T, Padding> >(*this);
+  }
+
+  // returns a view of a part of this view - row, col has to be a cell inside
+  // of the matrix
+  MatrixView<T, Padding> get_view(const unsigned int &row,
+                                  const unsigned int &col,
+                                  const unsigned int &rows,
+                                  const unsigned int &cols) const {
+    unsigned int valid_rows = (row < valid_rows_) ? valid_rows_ - row : 0;
+    unsigned int valid_cols = (col < valid_cols_) ? valid_cols_ - col : 0;
+
+    return MatrixView<T, Padding>(get_row(row) + col, stride_, rows, cols,
+                                  valid_rows, valid_cols, padding_);
+  }
+
+ private:
+  T *data_;
+  unsigned int stride_;
+  unsigned int rows_;
+  unsigned int cols_;
+  unsigned int valid_rows_;
+  unsigned int valid_cols_;
+  Padding padding_;
+};
+#endif
@@ -0,0 +1,110 @@
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "OutputBuffer.hpp"
+
+namespace {
+  const std::size_t PAGE = 4096;
+}
+
+const std::size_t OutputBuffer::CAPACITY;
+
+OutputBuffer::OutputBuffer(const std::string &filename) {
+  buffer_ = NULL;
+  target_ = NULL;
+  fd_ = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+  if(fd_ == -1) {
+    throw OutputBufferExce::CouldNotWrite("open " + filename + ": "
+                                          + std::strerror(errno));
+  }
+
+  try {
+    allocate(CAPACITY);
+  } catch(...) {
+    ::close(fd_);
+    throw;
+  }
+}
+
+OutputBuffer::OutputBuffer(std::string *target) {
+  buffer_ = NULL;
+  target_ = target;
+  fd_ = -1;
+  allocate(CAPACITY);
+}
+
+OutputBuffer::~OutputBuffer() {
+  try {
+    close();
+  } catch(...) {
+  }
+  free(buffer_);
+}
+
+void OutputBuffer::append(const char *data, const std::size_t &n) {
+  std::memcpy(get_space(n), data, n);
+  used_ += n;
+}
+
+void OutputBuffer::flush() {
+  if(target_ != NULL) {
+    target_->append(buffer_, used_);
+    used_ = 0;
+    return;
+  }
+  std::size_t done = 0;
+
+  while(done < used_) {
+    ssize_t written = write(fd_, buffer_ + done, used_ - done);
+
+    if(written < 0) {
+      if(errno == EINTR) {
+        continue;
+      }
+      used_ = 0;
+      throw OutputBufferExce::CouldNotWrite(std::strerror(errno));
+    }
+    done += written;
+  }
+  used_ = 0;
+}
+
+void OutputBuffer::close() {
+  flush();
+
+  if(fd_ != -1) {
+    int fd = fd_;
+
+    fd_ = -1;
+
+    if(::close(fd) != 0) {
+      throw OutputBufferExce::CouldNotWrite(std::strerror(errno));
+    }
+  }
+}
+
+void OutputBuffer::allocate(const std::size_t &capacity) {
+  void *memory = NULL;
+
+  if(posix_memalign(&memory, PAGE, capacity) != 0) {
+    throw std::bad_alloc();
+  }
+  free(buffer_);
+  buffer_ = static_cast<char *>(memory);
+  capacity_ = capacity;
+  used_ = 0;
+}
+
+void OutputBuffer::make_space(const std::size_t &n) {
+  flush();
+
+  if(n > capacity_) {
+    allocate((n + PAGE - 1) / PAGE * PAGE);
+  }
+}
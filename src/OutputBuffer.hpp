@@ -0,0 +1,99 @@
+#ifndef OUTPUT_BUFFER_HPP
+#define OUTPUT_BUFFER_HPP
+
+#include <cstddef>
+#include <exception>
+#include <string>
+
+namespace OutputBufferExce {
+  class CouldNotWrite : public std::exception {
+   public:
+
+    CouldNotWrite() {
+      msg =  "OutputBufferExce: CouldNotWrite\nThe file could not be written!\n";
+    }
+
+    CouldNotWrite(const std::string &s) {
+      msg =  "OutputBufferExce: CouldNotWrite\n"
+      "The file could not be written!\n" + s + '\n';
+    }
+
+    ~CouldNotWrite() throw() {
+    }
+
+    const char* what() const throw() {
+      return msg.c_str();
+    }
+
+   private:
+    std::string msg;
+  };
+}
+
+/**
+ * The OutputBuffer class collects bytes in a page aligned buffer and hands
+ * them to a file in large write() calls - or appends them to a string. The
+ * bytes are written in to the buffer in place: get_space(n) returns room for
+ * at least n bytes and advance(n) keeps them.
+ */
+class OutputBuffer {
+ public:
+  // the size of the buffer in byte
+  static const std::size_t CAPACITY = 1 << 20;
+
+  // creates or truncates the file
+  explicit OutputBuffer(const std::string &filename);
+
+  // appends the bytes to target
+  explicit OutputBuffer(std::string *target);
+
+  // flushes the bytes that are left - errors are ignored, call close() to
+  // see them
+  ~OutputBuffer();
+
+  // returns room for at least n bytes
+  inline char *get_space(const std::size_t &n) {
+    if(capacity_ - used_ < n) {
+      make_space(n);
+    }
+    return buffer_ + used_;
+  }
+
+  // keeps the next n bytes of the room returned by get_space()
+  inline void advance(const std::size_t &n) {
+    used_ += n;
+  }
+
+  inline void put(const char &c) {
+    *get_space(1) = c;
+    ++used_;
+  }
+
+  void append(const char *data, const std::size_t &n);
+
+  inline void append(const std::string &s) {
+    append(s.data(), s.size());
+  }
+
+  // hands the buffered bytes to the file or string
+  void flush();
+
+  // flushes and closes the file
+  void close();
+
+ private:
+  OutputBuffer(const OutputBuffer &);
+  OutputBuffer &operator=(const OutputBuffer &);
+
+  void allocate(const std::size_t &capacity);
+
+  // flushes and grows the buffer if n bytes do not fit in to it
+  void make_space(const std::size_t &n);
+
+  char *buffer_;
+  std::size_t capacity_;
+  std::size_t used_;
+  int fd_;
+  std::string *target_;
+};
+#endif
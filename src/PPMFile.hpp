@@ -2,14 +2,20 @@
 #define PPMFile_HPP
 
 #include <stdlib.h>
+#include <algorithm>
 #include <limits>
 #include <fstream>
 #include <exception>
 #include <vector>
 #include <sstream>
+#include <utility>
 
-#include "Pixel.hpp"
-#include "Matrix.hpp"
+#include "Image.hpp"
+#include "MappedFile.hpp"
+#include "OutputBuffer.hpp"
+#include "PPMFormat.hpp"
+#include "PPMTokenizer.hpp"
+#include "ThreadPool.hpp"
 
 namespace PPMFileExce {
   class BadHeader : public std::exception {
@@ -79,6 +85,28 @@ namespace PPMFileExce {
   };
 }
 
+/**
+ * What the header of a ppm file tells about the picture - returned by
+ * PPMFile::probe() without reading the body.
+ */
+struct PPMHeader {
+  PPMHeader() : magic_number(0), width(0), height(0), channels(0),
+                color_depth(0), body_offset(0), file_size(0) {
+  }
+
+  unsigned char magic_number;
+  unsigned int width;
+  unsigned int height;
+  unsigned char channels;
+  // 1 for P1 and P4
+  unsigned int color_depth;
+  // the position of the first byte of the pixels
+  std::size_t body_offset;
+  std::size_t file_size;
+  // the TUPLTYPE of a PAM file (P7), empty for the others
+  std::string tuple_type;
+};
+
 ///////////////////////////////////
 //            PPMFile            //
 ///////////////////////////////////
@@ -92,49 +120,157 @@ public:
    * Default constructor
    */
   PPMFile() {
+    file_size_ = 0;
     magic_number_ = 0;
     color_depth_ = 0;
-    mat_pic_ = new Matrix<Pixel<T> >();
+    tuple_depth_ = 0;
+    mat_pic_ = new Image<T>();
   }
 
   /**
    * @param filename is the full path to the file that shall be read
    */
   PPMFile(const std::string &filename) {
-    std::fstream file;
+    MappedFile *file = NULL;
 
-    file.open(filename.c_str(), std::ios::in|std::ios::binary);
+    try {
+      file = new MappedFile(filename);
+    } catch(const MappedFileExce::CouldNotMap &e) {
+      throw PPMFileExce::UnexpectedFileEnd("The file wasn't open ...");
+    }
+    file_size_ = file->get_size();
+    magic_number_ = 0;
+    color_depth_ = 0;
+    tuple_depth_ = 0;
+    mat_pic_ = NULL;
+    file->advise(0, file->get_size(), MappedFile::SEQUENTIAL);
+
+    // the pixels are parsed straight from the mapping
+    try {
+      std::size_t pos = 0;
+
+      read(reinterpret_cast<const unsigned char *>(file->get_data()),
+           file->get_size(), pos);
+    } catch(...) {
+      delete file;
+      delete mat_pic_;
+      throw;
+    }
+    delete file;
+  }
 
-    if(file.is_open()) {
-      unsigned char *buffer;
-      std::vector<unsigned char> *vec;
+  /**
+   * Reads the picture stored in the bytes [begin, end) of a mapped file - e.g.
+   * one frame of a file that holds several pictures
+   *
+   * @param file  the mapped file
+   * @param begin the position of the header of the picture
+   * @param end   the position after the last byte of the body
+   */
+  PPMFile(const MappedFile &file,
+          const std::size_t &begin,
+          const std::size_t &end) {
+    if(begin >= end || end > file.get_size()) {
+      std::ostringstream ss;
+      ss << "The file End was at Pos: " << file.get_size() << " while reading "
+      << "the bytes " << begin << " - " << end;
+
+      throw PPMFileExce::UnexpectedFileEnd(ss.str());
+    }
+    file_size_ = end - begin;
+    magic_number_ = 0;
+    color_depth_ = 0;
+    tuple_depth_ = 0;
+    mat_pic_ = NULL;
 
-      file.seekg (0, file.end);
-      file_size_ = file.tellg();
+    try {
+      std::size_t pos = begin;
 
-      buffer = new unsigned char [(int)file_size_];
-      vec = new std::vector<unsigned char>((int)file_size_);
+      read(reinterpret_cast<const unsigned char *>(file.get_data()), end, pos);
+    } catch(...) {
+      delete mat_pic_;
+      throw;
+    }
+  }
 
-      file.seekg (0, file.beg);
-      file.read(reinterpret_cast<char *>(buffer), (int)file_size_);
-      file.close();
+  /**
+   * Reads only the header of a ppm file - a prefix of a few kilobytes is read
+   * and parsed, a longer one only if comments make the header longer.
+   *
+   * @param filename is the full path to the file that shall be probed
+   * @return         the format and size of the picture and the position of its
+   *                 body
+   */
+  static PPMHeader probe(const std::string &filename) {
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
 
-      for(unsigned int i = 0; i < (int)file_size_; ++i) {
-        (*vec)[i] = buffer[i];
+    if(!file.is_open()) {
+      throw PPMFileExce::UnexpectedFileEnd("The file wasn't open ...");
+    }
+    file.seekg(0, std::ios::end);
+    std::size_t file_size = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    std::vector<unsigned char> prefix;
+    std::size_t length = 4096;
+    PPMFile<T> parser;
+    PPMHeader header;
+
+    while(true) {
+      std::size_t read = prefix.size();
+
+      length = std::min(length, file_size);
+      prefix.resize(length);
+
+      if(length > read && !file.read(reinterpret_cast<char *>(&prefix[read]),
+                                     length - read)) {
+        throw PPMFileExce::UnexpectedFileEnd("The file could not be read ...");
+      }
+      parser.magic_number_ = 0;
+      parser.color_depth_ = 0;
+      parser.tuple_depth_ = 0;
+      parser.tuple_type_.clear();
+      header.body_offset = 0;
+
+      try {
+        parser.read_header(prefix.empty() ? NULL : &prefix[0], length,
+                           header.body_offset, header.width, header.height);
+      } catch(const PPMFileExce::UnexpectedFileEnd &e) {
+        // the prefix ended within a comment
+        if(length == file_size) {
+          throw;
+        }
+        length *= 2;
+        continue;
       }
-      delete[] buffer;
 
-      magic_number_ = 0;
-      color_depth_ = 0;
-      mat_pic_ = NULL;
-      unsigned int vec_pos = 0;
+      // a header that reaches the end of the prefix may go on after it
+      if(header.body_offset < length || length == file_size) {
+        break;
+      }
+      length *= 2;
+    }
 
-      read(*vec, vec_pos);
+    if(parser.magic_number_ == 0) {
+      throw PPMFileExce::BadHeader("No Magic Number");
+    }
+    bool has_depth = parser.magic_number_ != 1 && parser.magic_number_ != 4;
 
-      delete vec;
-    } else {
-      throw PPMFileExce::UnexpectedFileEnd("The file wasn't open ...");
+    // the file ended within the header
+    if(header.body_offset == file_size
+       && (!parser.is_whitespace(prefix[file_size - 1])
+           || (has_depth && parser.color_depth_ == 0))) {
+      std::ostringstream ss;
+      ss << "The file End was at Pos: " << file_size;
+
+      throw PPMFileExce::UnexpectedFileEnd(ss.str());
     }
+    header.magic_number = parser.magic_number_;
+    header.channels = parser.get_subpixels();
+    header.color_depth = has_depth ? parser.color_depth_ : 1;
+    header.file_size = file_size;
+    header.tuple_type = parser.tuple_type_;
+    return header;
   }
 
   /**
@@ -144,7 +280,21 @@ public:
     file_size_ = copy.get_file_size();
     magic_number_ = copy.get_magic_number();
     color_depth_ = copy.get_color_depth();
-    mat_pic_ = new Matrix<Pixel<T> >(copy.get_mat_pic());
+    tuple_depth_ = copy.tuple_depth_;
+    tuple_type_ = copy.tuple_type_;
+    mat_pic_ = new Image<T>(copy.get_mat_pic());
+  }
+
+  /**
+   * Move Constructor - takes over the pixels of other
+   */
+  PPMFile(PPMFile&& other) {
+    file_size_ = other.get_file_size();
+    magic_number_ = other.get_magic_number();
+    color_depth_ = other.get_color_depth();
+    tuple_depth_ = other.tuple_depth_;
+    tuple_type_ = other.tuple_type_;
+    mat_pic_ = new Image<T>(other.release_mat_pic());
   }
 
   /**
@@ -155,135 +305,28 @@ public:
   }
 
   /**
-   * the function writes the data stored by the data vector in the file
+   * the function writes the picture in to the file
    *
    *
-   * @param filename is the full path to the file that shall be read
+   * @param filename is the full path to the file that shall be written
    */
   inline void write_to(const std::string &filename) const {
-    std::fstream file;
+    OutputBuffer out(filename);
 
-    file.open(filename.c_str(), std::ios::out|std::ios::binary);
-    file << to_string();
-    file.close();
+    write(out);
+    out.close();
   }
 
   /**
    * @return returns the file as a string
    */
   std::string to_string() const {
-    std::ostringstream ss;
-    char bit_temp = 0;
-    unsigned char bit_pos = 7;
-
-    ss << 'P';
-    ss << (int) magic_number_;
-    ss << '\n';
-    ss << mat_pic_->get_col_length();
-    ss << ' ';
-    ss << mat_pic_->get_row_length();
-    ss << '\n';
-
-    if(magic_number_ != 1 && magic_number_ != 4) {
-      ss << color_depth_;
-      ss << '\n';
-    }
-
-    Pixel<T> p;
-    T temp;
-    unsigned int ss_previous_length = 0;
-    unsigned int line_length = (unsigned int)ss.tellp() + 70;
-    for(unsigned int i = 0; i < mat_pic_->get_row_length(); ++i) {
-      for(unsigned int j = 0; j < mat_pic_->get_col_length(); ++j) {
-        p = mat_pic_->get_data(i, j);
-
-        for(unsigned int k = 0; k < p.size(); ++k) {
-          switch(magic_number_) {
-          case 1:
-            temp = p.get_pixel(k);
-
-            if(temp > 1) {
-              temp = 1;
-            } else if(temp < 0) {
-              temp = 0;
-            }
-            ss << (unsigned int) temp;
+    std::string result;
+    OutputBuffer out(&result);
 
-            if((unsigned int) ss.tellp() - ss_previous_length >= line_length) {
-              if(line_length != 70) {
-                line_length = 70;
-              }
-              ss << '\n';
-              ss_previous_length = ss.tellp();
-            }
-            break;
-          case 2:
-          case 3:
-            temp = p.get_pixel(k);
-
-            if(temp > 255) {
-              temp = 255;
-            } else if(temp < 0) {
-              temp = 0;
-            }
-            ss << (unsigned int) temp;
-            ss << ' ';
-
-            if((unsigned int) ss.tellp() - ss_previous_length >= line_length) {
-              if(line_length != 70) {
-                line_length = 70;
-              }
-              ss << '\n';
-              ss_previous_length = ss.tellp();
-            }
-            break;
-          case 4:            
-            bit_temp |= ((int)mat_pic_->get_data(i, j).get_pixel(0)) << bit_pos;
-
-            if(bit_pos == 0) {
-              ss << bit_temp;
-              bit_temp = 0;
-              bit_pos = 7;
-            } else {
-              --bit_pos;
-            }
-            break;
-          case 5:
-          case 6:
-            if(sizeof(T) > 1) {
-              if(color_depth_ > 255) {
-                unsigned char mask = (1<<8)-1;
-
-                ss << ((((int)p.get_pixel(k)) >> 8) & mask);
-                ss << ((((int)p.get_pixel(k))) & mask);
-              } else {
-                temp = p.get_pixel(k);
-
-                if(temp > 255) {
-                  temp = (unsigned char) 255;
-                } else if(temp < 0) {
-                  temp = (unsigned char) 0;
-                }
-                ss << (unsigned char) temp;
-              }
-            } else {
-              temp = p.get_pixel(k);
-
-              if(temp > 255) {
-                temp = (unsigned char) 255;
-              } else if(temp < 0) {
-                temp = (unsigned char) 0;
-              }
-              ss << (unsigned char) temp;
-            }
-          }
-        }
-      }
-    }
-    if(bit_pos != 7) {
-      ss << bit_temp;
-    }
-   return ss.str();
+    write(out);
+    out.flush();
+    return result;
   }
 
   /**
@@ -315,22 +358,47 @@ public:
   }
 
   /**
-   * @return the return value is a vector that holds all pixels of the ppm file
+   * @return the return value is the image that holds all pixels of the ppm
+   *         file
    */
-  inline Matrix<Pixel<T> > get_mat_pic() const {
+  inline const Image<T> &get_mat_pic() const {
     return *mat_pic_;
   }
 
   /**
-   * @return the return value is a vector that holds all pixels of the ppm file
+   * Hands the pixels of the ppm file over to the caller without copying them,
+   * the PPMFile is left with an empty matrix
+   *
+   * @return the return value is the image that held all pixels
    */
-  inline void set_mat_pic(const Matrix<Pixel<T> > &mat_pic, const int &color_depth) {
-    delete mat_pic_;
-    mat_pic_ = new Matrix<Pixel<T> >(mat_pic);
+  inline Image<T> release_mat_pic() {
+    return std::move(*mat_pic_);
+  }
+
+  /**
+   * @param mat_pic     the image with the pixels of the picture
+   * @param color_depth the colour depth of the pixels
+   */
+  inline void set_mat_pic(const Image<T> &mat_pic, const int &color_depth) {
+    set_mat_pic(Image<T>(mat_pic), color_depth);
+  }
+
+  /**
+   * Takes over the pixels of mat_pic without copying them
+   *
+   * @param mat_pic     the image with the pixels of the picture, it will be
+   *                    empty afterwards
+   * @param color_depth the colour depth of the pixels
+   */
+  inline void set_mat_pic(Image<T> &&mat_pic, const int &color_depth) {
+    *mat_pic_ = std::move(mat_pic);
 
     color_depth_ = color_depth;
+    tuple_depth_ = mat_pic_->get_channels();
 
-    if(mat_pic_->get_data(0, 0).size() > 1) {
+    if(tuple_depth_ != 1 && tuple_depth_ != 3) {
+      magic_number_ = 7;
+    } else if(tuple_depth_ == 3) {
       magic_number_ = 6;
     } else if(color_depth == 1) {
       magic_number_ = 4;
@@ -344,18 +412,40 @@ public:
    * @param vec determines the vector the information is read from
    */
   inline void set_data(const std::vector<unsigned char> &vec) {
-    unsigned int pos = 0;
+    std::size_t pos = 0;
 
-    read(vec, pos);
+    read(vec.empty() ? NULL : &vec[0], vec.size(), pos);
   }
 
   /**
-   * @return returns the amount of subpixels based on the magic number
+   * @return returns the amount of subpixels based on the magic number - the
+   *         DEPTH of a PAM file
    */
   inline unsigned int get_subpixels() const {
+    if(magic_number_ == 7) {
+      return tuple_depth_;
+    }
     return (magic_number_ == 3 || magic_number_ == 6) ? 3 : 1;
   }
 
+  /**
+   * @return the TUPLTYPE of a PAM file - if none was set, the one of the
+   *         subpixels, e.g. RGB_ALPHA for 4
+   */
+  inline std::string get_tuple_type() const {
+    if(tuple_type_.empty()) {
+      return PPMFormat::get_tuple_type(get_subpixels(), color_depth_);
+    }
+    return tuple_type_;
+  }
+
+  /**
+   * @param tuple_type the TUPLTYPE written to a PAM file
+   */
+  inline void set_tuple_type(const std::string &tuple_type) {
+    tuple_type_ = tuple_type;
+  }
+
   /**
    * @param size determines the file size of the PPM file
    */
@@ -373,19 +463,83 @@ public:
   /**
    * the assignment operator
    */
-  PPMFile<T> operator=(const PPMFile<T>& copy) {
+  PPMFile<T> &operator=(const PPMFile<T>& copy) {
     if(this != &copy) {
       file_size_ = copy.get_file_size();
       magic_number_ = copy.get_magic_number();
       color_depth_ = copy.get_color_depth();
-      delete mat_pic_;
-      mat_pic_ = new Matrix<Pixel<T> >(copy.get_mat_pic());
+      tuple_depth_ = copy.tuple_depth_;
+      tuple_type_ = copy.tuple_type_;
+      *mat_pic_ = copy.get_mat_pic();
+    }
+    return *this;
+  }
+
+  /**
+   * the move assignment operator - takes over the pixels of rhs
+   */
+  PPMFile<T> &operator=(PPMFile<T>&& rhs) {
+    if(this != &rhs) {
+      file_size_ = rhs.get_file_size();
+      magic_number_ = rhs.get_magic_number();
+      color_depth_ = rhs.get_color_depth();
+      tuple_depth_ = rhs.tuple_depth_;
+      tuple_type_ = rhs.tuple_type_;
+      *mat_pic_ = rhs.release_mat_pic();
     }
     return *this;
   }
 
 
 protected:
+  /**
+   * @return the largest sample that is written - the color depth of a 16 bit
+   *         picture, else 255
+   */
+  inline unsigned int get_sample_max() const {
+    return (sizeof(T) > 1 && color_depth_ > 255) ? color_depth_ : 255;
+  }
+
+  /**
+   * Writes the header and the pixels in the format of the magic number - the
+   * samples are clamped to get_sample_max() (to 1 for P1 and P4)
+   *
+   * @param out the buffer the file is written in to
+   */
+  void write(OutputBuffer &out) const {
+    unsigned int rows = mat_pic_->get_row_length();
+
+    if(magic_number_ == 7) {
+      PPMFormat::write_pam_header(out, mat_pic_->get_col_length(), rows,
+                                  mat_pic_->get_channels(), color_depth_,
+                                  get_tuple_type());
+    } else {
+      PPMFormat::write_header(out, magic_number_, mat_pic_->get_col_length(),
+                              rows, color_depth_);
+    }
+
+    switch(magic_number_) {
+    case 1:
+      PPMFormat::write_ascii(out, *mat_pic_, 0, rows, 1, false);
+      break;
+    case 2:
+    case 3:
+      PPMFormat::write_ascii(out, *mat_pic_, 0, rows, get_sample_max(), true);
+      break;
+    case 4:
+      PPMFormat::write_bits(out, *mat_pic_, 0, rows);
+      break;
+    case 5:
+    case 6:
+    case 7:
+      if(get_sample_max() > 255) {
+        PPMFormat::write_words(out, *mat_pic_, 0, rows, color_depth_);
+      } else {
+        PPMFormat::write_bytes(out, *mat_pic_, 0, rows, 255);
+      }
+    }
+  }
+
   /**
    * The function will return the next valid character of a ppm file
    * if there is a comment (indicated by a '#') the complete line will be
@@ -396,10 +550,11 @@ protected:
    * @return      the return value is the next valid character or if the file is
    *              not good 0 is returned
    */
-  char next_valid_char( const std::vector<unsigned char> &vec,
-                        unsigned int &vec_pos) {
-    char buffer = vec.at(vec_pos);
-    vec_pos++;
+  char next_valid_char( const unsigned char *data,
+                        const std::size_t &size,
+                        std::size_t &pos) {
+    char buffer = data[pos];
+    pos++;
 
     switch(buffer) {
       case '0':
@@ -420,21 +575,21 @@ protected:
         return buffer;
       case '#':
         while(buffer != '\n'){
-          if(vec_pos >= vec.size()) {
+          if(pos >= size) {
             std::ostringstream ss;
-            ss << "The file End was at Pos: " << vec_pos;
+            ss << "The file End was at Pos: " << pos;
 
             throw PPMFileExce::UnexpectedFileEnd(ss.str());
           } else {
-            buffer = vec.at(vec_pos);
-            vec_pos++;
+            buffer = data[pos];
+            pos++;
           }
         }
-        return next_valid_char(vec, vec_pos);
+        return next_valid_char(data, size, pos);
       default:
         std::ostringstream ss;
         ss << "The unallowed character was: " << buffer << " at Pos: " 
-        << vec_pos;
+        << pos;
         throw PPMFileExce::BadHeader(ss.str());
     }
   }
@@ -494,8 +649,9 @@ protected:
    * @param header_part_length is the array that holds the position of the
  *                             different informations from the header
    */
-  void read_header( const std::vector<unsigned char> &vec,
-                    unsigned int &vec_pos,
+  void read_header( const unsigned char *data,
+                    const std::size_t &size,
+                    std::size_t &pos,
                     unsigned int &width,
                     unsigned int &height) {
     bool skip_null = true;
@@ -504,15 +660,15 @@ protected:
     unsigned char part_nr = 0;
     std::ostringstream ss;
 
-    if(vec.size() != 0) {
-      buffer = next_valid_char(vec, vec_pos);
+    if(size != 0) {
+      buffer = next_valid_char(data, size, pos);
       if(buffer != 'P') {
         throw PPMFileExce::BadHeader("No Magic Number");
       }
     }
 
-    while(part_nr < 4 && vec_pos < vec.size()) {
-      buffer = next_valid_char(vec, vec_pos);
+    while(part_nr < 4 && pos < size) {
+      buffer = next_valid_char(data, size, pos);
 
       if(is_whitespace(buffer) && !skip_null) {
         end_of_sequence = true;
@@ -526,12 +682,16 @@ protected:
         if(end_of_sequence) {
           switch(part_nr) {
             case 0: magic_number_ = atoi(ss.str().c_str());
-              if(magic_number_ < 1 || magic_number_ > 6) {
+              if(magic_number_ < 1 || magic_number_ > 7) {
                 ss.clear();
                 ss.str("Magic number was: ");
                 ss << (int)magic_number_;
                 throw  PPMFileExce::BadHeader(ss.str());
               }
+              if(magic_number_ == 7) {
+                read_pam_header(data, size, pos, width, height);
+                return;
+              }
               break;
             case 1: width = atof(ss.str().c_str());
               break;
@@ -560,164 +720,353 @@ protected:
   } 
 
   /**
-   * the function reads the mat_pic of a ppm file in binary form
+   * Reads the rest of the header of a PAM file (P7) - lines of a keyword and a
+   * value up to the line ENDHDR, after which the body starts
    *
-   *
-   * @param file               is the file read from
-   * @param data               is the vector the read characters are pushed in
-   *                           to
-   * @param header_part_length is the array that holds the position of the
-   *                           different informations from the header
+   * @param data   determines the bytes of the file
+   * @param size   determines the amount of bytes of the file
+   * @param pos    determines the position after the magic number, it is moved
+   *               to the body
+   * @param width  is set to the WIDTH
+   * @param height is set to the HEIGHT
    */
-  void read_binary( const std::vector<unsigned char> &vec,
-                    unsigned int &vec_pos) {
-    bool subpixel = magic_number_ == 6;
-    bool one_byte = color_depth_ < 256; // TODO Find ppm with more than 255
-    unsigned int buffer = 0;
-    unsigned int mat_pos = 0;
-    Pixel<T> pixel;
+  void read_pam_header(const unsigned char *data,
+                       const std::size_t &size,
+                       std::size_t &pos,
+                       unsigned int &width,
+                       unsigned int &height) {
+    std::string tuple_type;
+    width = 0;
+    height = 0;
+    tuple_depth_ = 0;
+    color_depth_ = 0;
 
-    if(sizeof(T) < 2 && !one_byte) {
-      throw PPMFileExce::BadDataType();
-    }
+    while(true) {
+      while(pos < size && (is_whitespace(data[pos]) || data[pos] == '\r')) {
+        ++pos;
+      }
+      if(pos < size && data[pos] == '#') {
+        while(pos < size && data[pos] != '\n') {
+          ++pos;
+        }
+        continue;
+      }
+      if(pos >= size) {
+        std::ostringstream ss;
+        ss << "The file End was at Pos: " << pos << " before ENDHDR";
 
-    if(subpixel) {
-      pixel = Pixel<T>(3);
-    } else {
-      pixel = Pixel<T>(1);
-    }
+        throw PPMFileExce::UnexpectedFileEnd(ss.str());
+      }
+      std::string keyword;
+      std::string value;
 
-    for(unsigned int i = vec_pos; i < vec.size();) {
-      if(subpixel) {
-        if(one_byte) {
-          for(int j = 0; j < 3; ++j, ++i) {
-            pixel.set_pixel(j, vec.at(i));
-          }
-        } else {
-          buffer = 0; 
-
-          for(int j = 0; j < 3; ++j, ++i) {
-            buffer |= vec.at(i);
-            ++i;
-            buffer <<= 8;
-            buffer |= vec.at(i);
-            ++i;
-            pixel.set_pixel(0, buffer);
-
-            buffer = 0;
-          }
-        }
-      } else {
-        if(one_byte) {
-          if(magic_number_ != 4) {
-            pixel.set_pixel(0, vec.at(i));
-          } else {
-            for(int j = 7; j >= 0; --j) {
-              pixel.set_pixel(0, (0 != (int)(vec.at(i) & (1 << j))));
-              if(j != 0) {
-                mat_pic_->set_data(mat_pos, pixel);
-                mat_pos++;
-              }
-            }
-          }
-          ++i;
-        } else {
-          buffer = 0;
+      while(pos < size && !is_whitespace(data[pos]) && data[pos] != '\r') {
+        keyword += data[pos++];
+      }
+      while(pos < size && (data[pos] == ' ' || data[pos] == '\t')) {
+        ++pos;
+      }
+      while(pos < size && data[pos] != '\n') {
+        value += data[pos++];
+      }
+      while(!value.empty() && (is_whitespace(value[value.size() - 1])
+                               || value[value.size() - 1] == '\r')) {
+        value.erase(value.size() - 1);
+      }
 
-          buffer |= vec.at(i);
-          ++i;
-          buffer <<= 8;
-          buffer |= vec.at(i);
-          ++i;
+      if(keyword == "ENDHDR") {
+        if(pos >= size) {
+          std::ostringstream ss;
+          ss << "The file End was at Pos: " << pos << " after ENDHDR";
 
-          pixel.set_pixel(0, buffer);
+          throw PPMFileExce::UnexpectedFileEnd(ss.str());
         }
+        ++pos;
+        break;
+      } else if(keyword == "TUPLTYPE") {
+        tuple_type += (tuple_type.empty() ? "" : " ") + value;
+      } else if(keyword == "WIDTH") {
+        width = read_pam_number(keyword, value);
+      } else if(keyword == "HEIGHT") {
+        height = read_pam_number(keyword, value);
+      } else if(keyword == "DEPTH") {
+        tuple_depth_ = read_pam_number(keyword, value);
+      } else if(keyword == "MAXVAL") {
+        color_depth_ = read_pam_number(keyword, value);
+      } else {
+        throw PPMFileExce::BadHeader("Unknown keyword: " + keyword);
       }
-      mat_pic_->set_data(mat_pos, pixel);
-      mat_pos++;
     }
 
-    unsigned int last_row = mat_pos / mat_pic_->get_col_length();
-    unsigned int last_col = mat_pos % mat_pic_->get_col_length();
+    if(width == 0 || height == 0) {
+      throw PPMFileExce::BadHeader("WIDTH and HEIGHT are needed");
+    }
+    if(tuple_depth_ < 1 || tuple_depth_ > 4) {
+      std::ostringstream ss;
+      ss << "Depth was: " << (int)tuple_depth_ << " - 1 to 4 are supported";
+      throw PPMFileExce::BadHeader(ss.str());
+    }
+    if(color_depth_ < 1 || color_depth_ > 65535) {
+      std::ostringstream ss;
+      ss << "Color depth was: " << color_depth_;
+      throw PPMFileExce::BadHeader(ss.str());
+    }
+    tuple_type_ = tuple_type;
+  }
+
+  /**
+   * @return the value of a keyword of a PAM header as a number
+   */
+  unsigned int read_pam_number(const std::string &keyword,
+                               const std::string &value) {
+    if(value.empty() || value.size() > 9
+       || value.find_first_not_of("0123456789") != std::string::npos) {
+      throw PPMFileExce::BadHeader(keyword + " was: " + value);
+    }
+    return atoi(value.c_str());
+  }
+
+  /**
+   * the function reads the mat_pic of a ppm file in binary form
+   *
+   *
+   * @param data determines the bytes of the file
+   * @param size determines the amount of bytes of the file
+   * @param pos  determines the position of the body, it is moved to the end
+   */
+  void read_binary( const unsigned char *data,
+                    const std::size_t &size,
+                    std::size_t &pos) {
+    bool one_byte = color_depth_ < 256;
+
+    if(sizeof(T) < 2 && !one_byte) {
+      throw PPMFileExce::BadDataType();
+    }
+    read_samples(data, size, pos, one_byte ? 1 : 2);
+  }
 
-    if(last_row - mat_pic_->get_row_length() != 0 && last_col != 0) {
+  /**
+   * Reads a binary body straight in to the planes of the picture - the length
+   * of the body is checked once, the bytes are read unchecked. Two byte
+   * samples are stored most significant byte first, P4 rows are padded to
+   * whole bytes.
+   *
+   * @param data  determines the bytes of the file
+   * @param size  determines the amount of bytes of the file
+   * @param pos   determines the position of the body, it is moved to the end
+   * @param bytes determines the bytes per subpixel - 1 or 2
+   */
+  void read_samples(const unsigned char *data,
+                    const std::size_t &size,
+                    std::size_t &pos,
+                    const unsigned int &bytes) {
+    unsigned int rows = mat_pic_->get_row_length();
+    unsigned int cols = mat_pic_->get_col_length();
+    unsigned char channels = mat_pic_->get_channels();
+    bool bits = magic_number_ == 4;
+    std::size_t row_bytes = bits ? ((std::size_t)cols + 7) / 8
+                                 : (std::size_t)cols * channels * bytes;
+    std::size_t body = size - pos;
+
+    if(body < row_bytes * rows) {
       std::ostringstream ss;
 
       ss << "The source file for the PPMFile ended before the whole matrix was "
-      << "filled. Last read Pixel:\nRow: " << last_row << "\tCol: " << last_col
-      << "From:\nRows: " << mat_pic_->get_row_length() << "\tCols: "
-      << mat_pic_->get_col_length() << "\n";
+      << "filled. Bytes of the body: " << body << "\tExpected: "
+      << row_bytes * rows << "\n";
 
       throw PPMFileExce::UnexpectedFileEnd(ss.str());
-    } 
+    } else if(body > row_bytes * rows) {
+      std::ostringstream ss;
+      ss << "The source file for the PPMFile holds more pixels than the header "
+      << "announced. The size of the matrix was:\nRow: " << rows << "\tCol: "
+      << cols << "\n";
+      throw std::range_error(ss.str());
+    }
+
+    const unsigned char *body_data = data + pos;
+    Image<T> &pic = *mat_pic_;
+
+    MatrixExprDetail::for_each_band(rows, cols,
+        [&pic, body_data, row_bytes, bytes, bits](unsigned int begin,
+                                                  unsigned int end) {
+          for(unsigned int i = begin; i < end; ++i) {
+            if(bits) {
+              PPMFormat::read_bits(body_data + i * row_bytes, pic, i);
+            } else if(bytes == 1) {
+              PPMFormat::read_bytes(body_data + i * row_bytes, pic, i);
+            } else {
+              PPMFormat::read_words(body_data + i * row_bytes, pic, i);
+            }
+          }
+        });
+    pos = size;
   }
 
   /**
-   * Reads a ASCII PPM body
-   * @param vec     determines the vector the information is stored in 
-   * @param vec_pos determines the position the "reader" is in the vector (file)
+   * Stores the samples of an ASCII body one after an other in to the planes of
+   * a picture, starting at a sample index (row, column and channel)
    */
-  void read_ascii(const std::vector<unsigned char> &vec,
-                  unsigned int &vec_pos) {
-    bool skip_null = false;
-    bool end_of_sequence = false;
-    bool subpixel = magic_number_ == 3;
-    char buffer = 0;
-    unsigned char pixel_nr = 0;
-    unsigned int mat_pos = 0;
-    Pixel<T> pixel;
-    std::ostringstream ss;
-
-    if(subpixel) {
-      pixel = Pixel<T>(3);
-    } else {
-      pixel = Pixel<T>(1);
+  class SampleSink {
+   public:
+    SampleSink(Image<T> &pic, const std::size_t &index) : pic_(pic) {
+      channels_ = pic.get_channels();
+      cols_ = pic.get_col_length();
+      index_ = index;
+      total_ = (std::size_t)pic.get_row_length() * cols_ * channels_;
+      channel_ = 0;
+      col_ = 0;
+      row_ = 0;
+
+      if(cols_ != 0 && channels_ != 0) {
+        row_ = index / ((std::size_t)cols_ * channels_);
+        col_ = index / channels_ % cols_;
+        channel_ = index % channels_;
+      }
+      load_rows();
     }
 
-    while(vec_pos < vec.size()) {
-      buffer = next_valid_char(vec, vec_pos);
+    inline void operator()(const unsigned int &value) {
+      if(index_ >= total_) {
+        std::ostringstream ss;
+        ss << "The source file for the PPMFile holds more pixels than the "
+        << "header announced. The size of the matrix was:\nRow: "
+        << pic_.get_row_length() << "\tCol: " << pic_.get_col_length() << "\n";
+        throw std::range_error(ss.str());
+      }
+      rows_[channel_][col_] = value;
+      ++index_;
+
+      if(++channel_ == channels_) {
+        channel_ = 0;
 
-      if(is_whitespace(buffer)) {
-        if(!skip_null) {
-          end_of_sequence = true;
+        if(++col_ == cols_) {
+          col_ = 0;
+          ++row_;
+          load_rows();
         }
-      } else {
-        skip_null = false;
       }
+    }
 
-      if(!skip_null) {
-        ss << buffer;
+    // returns the index of the next sample
+    inline std::size_t get_index() const {
+      return index_;
+    }
 
-        if(end_of_sequence || magic_number_ == 1) {
-          pixel.set_pixel(pixel_nr, atof(ss.str().c_str()));
-          pixel_nr++;
-          ss.clear();
-          ss.str("");
-          skip_null = true;
-          end_of_sequence = false;
+    // returns true if every sample of the picture was stored
+    inline bool is_full() const {
+      return index_ >= total_;
+    }
 
-          if((pixel_nr == 3 && subpixel) || (pixel_nr == 1 && !subpixel)) {
-            mat_pic_->set_data(mat_pos, pixel);
-            pixel_nr = 0;
-            mat_pos ++;
-          }
+   private:
+    inline void load_rows() {
+      if(row_ < pic_.get_row_length()) {
+        for(unsigned char c = 0; c < channels_ && c < 3; ++c) {
+          rows_[c] = pic_.get_plane(c).get_row(row_);
         }
       }
     }
 
-    unsigned int last_row = mat_pos / mat_pic_->get_col_length();
-    unsigned int last_col = mat_pos % mat_pic_->get_col_length();
+    Image<T> &pic_;
+    T *rows_[3];
+    std::size_t index_;
+    std::size_t total_;
+    unsigned int row_;
+    unsigned int col_;
+    unsigned int cols_;
+    unsigned char channel_;
+    unsigned char channels_;
+  };
+
+  /**
+   * Reads a ASCII PPM body - the values are tokenized by PPMTokenizer and
+   * stored straight in to the planes. A large body is split in to chunks that
+   * are counted and then read in parallel; the counts before a chunk give the
+   * sample its first value is stored at.
+   * @param data determines the bytes of the file
+   * @param size determines the amount of bytes of the file
+   * @param pos  determines the position the "reader" is in the file
+   */
+  void read_ascii(const unsigned char *data,
+                  const std::size_t &size,
+                  std::size_t &pos) {
+    std::vector<std::size_t> bounds = PPMTokenizer::split(
+        data, pos, size, PPMTokenizer::CHUNK_BYTES);
+    unsigned int chunks = bounds.size() - 1;
+    std::vector<std::size_t> starts(chunks + 1, 0);
+    std::vector<std::size_t> stops(chunks, 0);
+    bool single_digits = magic_number_ == 1;
+    Image<T> &pic = *mat_pic_;
+    std::size_t total = (std::size_t)pic.get_row_length()
+                        * pic.get_col_length() * pic.get_channels();
+
+    if(chunks > 1) {
+      ThreadPool::get_default().parallel_for(chunks, 1,
+          [data, single_digits, &bounds, &starts, &stops](unsigned int begin,
+                                                          unsigned int end) {
+            for(unsigned int k = begin; k < end; ++k) {
+              stops[k] = PPMTokenizer::count(data, bounds[k], bounds[k + 1],
+                                             single_digits, starts[k + 1]);
+            }
+          });
+      check_stops(data, bounds, stops);
+
+      for(unsigned int k = 0; k < chunks; ++k) {
+        starts[k + 1] += starts[k];
+      }
+
+      if(starts[chunks] > total) {
+        std::ostringstream ss;
+        ss << "The source file for the PPMFile holds more pixels than the "
+        << "header announced. The size of the matrix was:\nRow: "
+        << pic.get_row_length() << "\tCol: " << pic.get_col_length() << "\n";
+        throw std::range_error(ss.str());
+      }
+    }
+
+    ThreadPool::get_default().parallel_for(chunks, 1,
+        [data, single_digits, &pic, &bounds, &starts, &stops](
+            unsigned int begin, unsigned int end) {
+          for(unsigned int k = begin; k < end; ++k) {
+            SampleSink sink = SampleSink(pic, starts[k]);
+
+            stops[k] = PPMTokenizer::scan(data, bounds[k], bounds[k + 1],
+                                          single_digits, sink);
+            starts[k + 1] = sink.get_index();
+          }
+        });
+    check_stops(data, bounds, stops);
+    pos = size;
 
-    if(last_row - mat_pic_->get_row_length() != 0 && last_col != 0) {
+    if(starts[chunks] < total) {
       std::ostringstream ss;
 
       ss << "The source file for the PPMFile ended before the whole matrix was "
-      << "filled. Last read Pixel:\nRow: " << last_row << "\tCol: " << last_col
-      << "From:\nRows: " << mat_pic_->get_row_length() << "\tCols: "
+      << "filled. Read samples: " << starts[chunks] << "\nFrom:\nRows: "
+      << mat_pic_->get_row_length() << "\tCols: "
       << mat_pic_->get_col_length() << "\n";
 
       throw PPMFileExce::UnexpectedFileEnd(ss.str());
-    } 
+    }
+  }
+
+  /**
+   * Throws for the first chunk that was not scanned to its end
+   * @param data   determines the bytes of the file
+   * @param bounds determines the positions the chunks start at
+   * @param stops  determines the positions the scans of the chunks stopped at
+   */
+  void check_stops(const unsigned char *data,
+                   const std::vector<std::size_t> &bounds,
+                   const std::vector<std::size_t> &stops) const {
+    for(unsigned int k = 0; k < stops.size(); ++k) {
+      if(stops[k] != bounds[k + 1]) {
+        std::ostringstream ss;
+        ss << "The unallowed character was: " << data[stops[k]] << " at Pos: "
+        << stops[k];
+        throw PPMFileExce::BadHeader(ss.str());
+      }
+    }
   }
 
   /*
@@ -731,27 +1080,50 @@ protected:
    * @param header_part_length is the array that holds the position of the 
    *                           different informations from the header
    */
-  void read(const std::vector<unsigned char> &vec, unsigned int &vec_pos) {
+  void read(const unsigned char *data,
+            const std::size_t &size,
+            std::size_t &pos) {
 
     unsigned int width = 0;
     unsigned int height = 0;
+    // a file that can not be read leaves the picture and its header as they
+    // were
+    Image<T> *temp = mat_pic_;
+    unsigned char magic_number = magic_number_;
+    unsigned int color_depth = color_depth_;
+    unsigned char tuple_depth = tuple_depth_;
+    std::string tuple_type = tuple_type_;
 
-    read_header(vec, vec_pos, width, height);
+    try {
+      read_header(data, size, pos, width, height);
 
-    Matrix<Pixel<T> > *temp = mat_pic_;
-    mat_pic_ = new Matrix<Pixel<T> >(height, width);
+      mat_pic_ = new Image<T>(height, width, get_subpixels());
 
-    if(magic_number_ < 4) {
-      read_ascii(vec, vec_pos);
-    } else {
-      read_binary(vec, vec_pos);
+      if(magic_number_ < 4) {
+        read_ascii(data, size, pos);
+      } else {
+        read_binary(data, size, pos);
+      }
+    } catch(...) {
+      if(mat_pic_ != temp) {
+        delete mat_pic_;
+        mat_pic_ = temp;
+      }
+      magic_number_ = magic_number;
+      color_depth_ = color_depth;
+      tuple_depth_ = tuple_depth;
+      tuple_type_ = tuple_type;
+      throw;
     }
     delete temp;
   }
 
   double file_size_;
-  Matrix<Pixel<T> > *mat_pic_;
+  Image<T> *mat_pic_;
   unsigned char magic_number_;
   unsigned int color_depth_;
+  // the DEPTH and TUPLTYPE of a PAM file
+  unsigned char tuple_depth_;
+  std::string tuple_type_;
 };
 #endif
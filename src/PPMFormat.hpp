@@ -0,0 +1,583 @@
+#ifndef PPM_FORMAT_HPP
+#define PPM_FORMAT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "Image.hpp"
+#include "OutputBuffer.hpp"
+#include "ThreadPool.hpp"
+
+/**
+ * Readers and writers for the parts of a ppm file - one per magic number and
+ * sample width, so the loops over the rows [begin, end) of a picture do not
+ * look at the format for every sample. The written samples are clamped to
+ * [0, max] and cut to integers.
+ *
+ * P7 (PAM) bodies are the ones of P5 / P6 with one to four channels.
+ *
+ * Two byte samples are stored most significant byte first; planes of
+ * unsigned short are swapped 8 samples at a time with SSE2, so 16 bit
+ * pictures are read and written at the speed of 8 bit ones.
+ */
+namespace PPMFormat {
+  // the length an ASCII line reaches before it is broken
+  const unsigned int LINE_LENGTH = 70;
+
+  // the amount of bands of ASCII rows that are formatted at once
+  const unsigned int ASCII_BANDS_PER_PASS = 16;
+
+  // the samples of the bits of every P4 byte, the highest bit first, and
+  // every byte with its bits in reverse order
+  struct BitTable {
+    BitTable() {
+      for(unsigned int b = 0; b < 256; ++b) {
+        reversed[b] = 0;
+
+        for(unsigned int k = 0; k < 8; ++k) {
+          samples[b][k] = (b >> (7 - k)) & 1;
+          reversed[b] |= ((b >> k) & 1) << (7 - k);
+        }
+      }
+    }
+
+    unsigned char samples[256][8];
+    unsigned char reversed[256];
+  };
+
+  inline const BitTable &get_bits() {
+    static const BitTable table;
+    return table;
+  }
+
+  // returns the sample clamped to [0, max] and cut to an integer
+  template <typename T>
+  inline unsigned int get_sample(const T &value,
+                                 const unsigned int &max,
+                                 std::false_type) {
+    double v = value;
+
+    if(!(v > 0)) {
+      return 0;
+    }
+    return (v > max) ? max : (unsigned int)v;
+  }
+
+  // integer samples are clamped without the way over double
+  template <typename T>
+  inline unsigned int get_sample(const T &value,
+                                 const unsigned int &max,
+                                 std::true_type) {
+    if(!(value > 0)) {
+      return 0;
+    }
+    return ((unsigned long long)value > max) ? max : (unsigned int)value;
+  }
+
+  template <typename T>
+  inline unsigned int get_sample(const T &value, const unsigned int &max) {
+    return get_sample(value, max, std::is_integral<T>());
+  }
+
+  // stores n two byte samples of src in to dst
+  template <typename T>
+  inline void load_words(const unsigned char *src,
+                         T *dst,
+                         const unsigned int &n) {
+    for(unsigned int j = 0; j < n; ++j) {
+      dst[j] = (src[2 * j] << 8) | src[2 * j + 1];
+    }
+  }
+
+  inline void load_words(const unsigned char *src,
+                         unsigned short *dst,
+                         const unsigned int &n) {
+    unsigned int j = 0;
+
+#ifdef __SSE2__
+    for(; j + 8 <= n; j += 8) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * j));
+
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + j),
+                       _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+    }
+#endif
+    for(; j < n; ++j) {
+      dst[j] = (src[2 * j] << 8) | src[2 * j + 1];
+    }
+  }
+
+  // stores n samples of src as two bytes each in to dst
+  template <typename T>
+  inline void store_words(const T *src,
+                          unsigned char *dst,
+                          const unsigned int &n,
+                          const unsigned int &max) {
+    for(unsigned int j = 0; j < n; ++j) {
+      unsigned int sample = get_sample(src[j], max);
+
+      dst[2 * j] = sample >> 8;
+      dst[2 * j + 1] = sample & 0xFF;
+    }
+  }
+
+  inline void store_words(const unsigned short *src,
+                          unsigned char *dst,
+                          const unsigned int &n,
+                          const unsigned int &max) {
+    unsigned int j = 0;
+
+#ifdef __SSE2__
+    if(max >= 0xFFFF) {
+      for(; j + 8 <= n; j += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + j));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 2 * j),
+                         _mm_or_si128(_mm_slli_epi16(v, 8),
+                                      _mm_srli_epi16(v, 8)));
+      }
+    }
+#endif
+    for(; j < n; ++j) {
+      unsigned int sample = get_sample(src[j], max);
+
+      dst[2 * j] = sample >> 8;
+      dst[2 * j + 1] = sample & 0xFF;
+    }
+  }
+
+  // P5 / P6 - stores the one byte samples of row i, the channels of a pixel
+  // one after an other, in to the planes
+  template <typename T>
+  void read_bytes(const unsigned char *src,
+                  Image<T> &pic,
+                  const unsigned int &i) {
+    unsigned int cols = pic.get_col_length();
+    unsigned char channels = pic.get_channels();
+
+    for(unsigned char c = 0; c < channels; ++c) {
+      T *row = pic.get_plane(c).get_row(i);
+
+      for(unsigned int j = 0; j < cols; ++j) {
+        row[j] = src[(std::size_t)j * channels + c];
+      }
+    }
+  }
+
+  // P5 / P6 - the same for two byte samples
+  template <typename T>
+  void read_words(const unsigned char *src,
+                  Image<T> &pic,
+                  const unsigned int &i) {
+    unsigned int cols = pic.get_col_length();
+    unsigned char channels = pic.get_channels();
+
+    if(channels == 1) {
+      load_words(src, pic.get_plane(0).get_row(i), cols);
+      return;
+    }
+
+    for(unsigned char c = 0; c < channels; ++c) {
+      T *row = pic.get_plane(c).get_row(i);
+
+      for(unsigned int j = 0; j < cols; ++j) {
+        std::size_t k = ((std::size_t)j * channels + c) * 2;
+
+        row[j] = (src[k] << 8) | src[k + 1];
+      }
+    }
+  }
+
+  inline void write_header(OutputBuffer &out,
+                           const unsigned char &magic_number,
+                           const unsigned int &cols,
+                           const unsigned int &rows,
+                           const unsigned int &color_depth) {
+    char *dst = out.get_space(40);
+    int length;
+
+    if(magic_number != 1 && magic_number != 4) {
+      length = sprintf(dst, "P%d\n%u %u\n%u\n", (int)magic_number, cols, rows,
+                       color_depth);
+    } else {
+      length = sprintf(dst, "P%d\n%u %u\n", (int)magic_number, cols, rows);
+    }
+    out.advance(length);
+  }
+
+  // returns the TUPLTYPE of a PAM file with the amount of channels
+  inline std::string get_tuple_type(const unsigned int &channels,
+                                    const unsigned int &max) {
+    switch(channels) {
+    case 1:
+      return (max == 1) ? "BLACKANDWHITE" : "GRAYSCALE";
+    case 2:
+      return "GRAYSCALE_ALPHA";
+    case 3:
+      return "RGB";
+    case 4:
+      return "RGB_ALPHA";
+    default:
+      return "";
+    }
+  }
+
+  // P7 - the header of a PAM file, the TUPLTYPE is left out if it is empty
+  inline void write_pam_header(OutputBuffer &out,
+                               const unsigned int &cols,
+                               const unsigned int &rows,
+                               const unsigned char &channels,
+                               const unsigned int &color_depth,
+                               const std::string &tuple_type) {
+    char *dst = out.get_space(80);
+    int length = sprintf(dst, "P7\nWIDTH %u\nHEIGHT %u\nDEPTH %u\nMAXVAL %u\n",
+                         cols, rows, (unsigned int)channels, color_depth);
+
+    out.advance(length);
+
+    if(!tuple_type.empty()) {
+      out.append("TUPLTYPE " + tuple_type + "\n");
+    }
+    out.append(std::string("ENDHDR\n"));
+  }
+
+  // P5 / P6 - one byte per sample, the channels of a pixel one after an other
+  template <typename T>
+  void write_bytes(OutputBuffer &out,
+                   const Image<T> &pic,
+                   const unsigned int &begin,
+                   const unsigned int &end,
+                   const unsigned int &max) {
+    unsigned int cols = pic.get_col_length();
+    unsigned char channels = pic.get_channels();
+
+    for(unsigned int i = begin; i < end; ++i) {
+      unsigned char *dst = reinterpret_cast<unsigned char *>(
+          out.get_space((std::size_t)cols * channels));
+
+      for(unsigned char c = 0; c < channels; ++c) {
+        const T *row = pic.get_plane(c).get_row(i);
+
+        for(unsigned int j = 0; j < cols; ++j) {
+          dst[(std::size_t)j * channels + c] = get_sample(row[j], max);
+        }
+      }
+      out.advance((std::size_t)cols * channels);
+    }
+  }
+
+  // P5 / P6 - two bytes per sample, the most significant first
+  template <typename T>
+  void write_words(OutputBuffer &out,
+                   const Image<T> &pic,
+                   const unsigned int &begin,
+                   const unsigned int &end,
+                   const unsigned int &max) {
+    unsigned int cols = pic.get_col_length();
+    unsigned char channels = pic.get_channels();
+
+    for(unsigned int i = begin; i < end; ++i) {
+      unsigned char *dst = reinterpret_cast<unsigned char *>(
+          out.get_space((std::size_t)cols * channels * 2));
+
+      if(channels == 1) {
+        store_words(pic.get_plane(0).get_row(i), dst, cols, max);
+        out.advance((std::size_t)cols * 2);
+        continue;
+      }
+
+      for(unsigned char c = 0; c < channels; ++c) {
+        const T *row = pic.get_plane(c).get_row(i);
+
+        for(unsigned int j = 0; j < cols; ++j) {
+          unsigned int sample = get_sample(row[j], max);
+          std::size_t k = ((std::size_t)j * channels + c) * 2;
+
+          dst[k] = sample >> 8;
+          dst[k + 1] = sample & 0xFF;
+        }
+      }
+      out.advance((std::size_t)cols * channels * 2);
+    }
+  }
+
+  // stores the eight samples of a byte in to dst
+  template <typename T>
+  inline void store_bits(const unsigned char *samples, T *dst) {
+    for(unsigned int k = 0; k < 8; ++k) {
+      dst[k] = samples[k];
+    }
+  }
+
+  inline void store_bits(const unsigned char *samples, unsigned char *dst) {
+    std::memcpy(dst, samples, 8);
+  }
+
+  // P4 - stores the bits of row i in to the first plane, a byte holds eight
+  // samples
+  template <typename T>
+  void read_bits(const unsigned char *src,
+                 Image<T> &pic,
+                 const unsigned int &i) {
+    const BitTable &table = get_bits();
+    unsigned int cols = pic.get_col_length();
+    T *row = pic.get_plane(0).get_row(i);
+    unsigned int j = 0;
+
+    for(; j + 8 <= cols; j += 8) {
+      store_bits(table.samples[src[j >> 3]], row + j);
+    }
+    if(j < cols) {
+      const unsigned char *samples = table.samples[src[j >> 3]];
+
+      for(; j < cols; ++j) {
+        row[j] = samples[j & 7];
+      }
+    }
+  }
+
+  // packs the n samples of a row in to (n + 7) / 8 bytes - the samples are
+  // clamped to [0, 1] and the last byte is padded with 0 bits
+  template <typename T>
+  inline void pack_bits(const T *row,
+                        unsigned char *dst,
+                        const unsigned int &n) {
+    unsigned int j = 0;
+
+    for(; j + 8 <= n; j += 8) {
+      unsigned int byte = 0;
+
+      for(unsigned int k = 0; k < 8; ++k) {
+        byte = (byte << 1) | get_sample(row[j + k], 1);
+      }
+      dst[j >> 3] = byte;
+    }
+
+    if(j < n) {
+      unsigned int byte = 0;
+
+      for(unsigned int k = 0; k < 8; ++k) {
+        byte = (byte << 1) | ((j + k < n) ? get_sample(row[j + k], 1) : 0);
+      }
+      dst[j >> 3] = byte;
+    }
+  }
+
+  // byte samples are compared 16 at a time, the mask holds the first sample
+  // in the lowest bit
+  inline void pack_bits(const unsigned char *row,
+                        unsigned char *dst,
+                        const unsigned int &n) {
+    unsigned int j = 0;
+
+#ifdef __SSE2__
+    const BitTable &table = get_bits();
+    const __m128i zero = _mm_setzero_si128();
+
+    for(; j + 16 <= n; j += 16) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + j));
+      unsigned int set = ~_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) & 0xFFFF;
+
+      dst[j >> 3] = table.reversed[set & 0xFF];
+      dst[(j >> 3) + 1] = table.reversed[set >> 8];
+    }
+#endif
+    pack_bits<unsigned char>(row + j, dst + (j >> 3), n - j);
+  }
+
+  // P4 - eight pixels of the first channel per byte, the first pixel in the
+  // highest bit; every row starts a new byte
+  template <typename T>
+  void write_bits(OutputBuffer &out,
+                  const Image<T> &pic,
+                  const unsigned int &begin,
+                  const unsigned int &end) {
+    std::size_t row_bytes = ((std::size_t)pic.get_col_length() + 7) / 8;
+
+    for(unsigned int i = begin; i < end; ++i) {
+      unsigned char *dst = reinterpret_cast<unsigned char *>(
+          out.get_space(row_bytes));
+
+      pack_bits(pic.get_plane(0).get_row(i), dst, pic.get_col_length());
+      out.advance(row_bytes);
+    }
+  }
+
+  // the decimal digits of 0 - 999 followed by a space - unpadded and padded
+  // to three digits
+  struct DigitTable {
+    DigitTable() {
+      for(unsigned int v = 0; v < 1000; ++v) {
+        lengths[v] = (v < 10) ? 1 : (v < 100) ? 2 : 3;
+
+        for(unsigned int k = 0, d = 100; k < 3; ++k, d /= 10) {
+          padded[v][k] = '0' + v / d % 10;
+        }
+        padded[v][3] = ' ';
+
+        for(unsigned int k = 0; k < 4; ++k) {
+          chars[v][k] = (k <= lengths[v]) ? padded[v][3 - lengths[v] + k] : ' ';
+        }
+      }
+    }
+
+    char chars[1000][4];
+    char padded[1000][4];
+    unsigned char lengths[1000];
+  };
+
+  inline const DigitTable &get_digits() {
+    static const DigitTable table;
+    return table;
+  }
+
+  // writes the digits of value followed by a space to dst and returns the
+  // amount of digits - dst needs room for the digits and four more bytes
+  inline unsigned int format(const unsigned int &value, char *dst) {
+    const DigitTable &table = get_digits();
+
+    if(value < 1000) {
+      std::memcpy(dst, table.chars[value], 4);
+      return table.lengths[value];
+    }
+    unsigned int length = format(value / 1000, dst);
+
+    std::memcpy(dst + length, table.padded[value % 1000], 4);
+    return length + 3;
+  }
+
+  // returns the most characters a row of ASCII samples takes - including the
+  // line breaks and room for format()
+  inline std::size_t get_ascii_bound(const unsigned int &cols,
+                                     const unsigned char &channels,
+                                     const unsigned int &max) {
+    std::size_t digits = 1;
+
+    for(unsigned int v = max; v >= 10; v /= 10) {
+      ++digits;
+    }
+    std::size_t chars = (std::size_t)cols * channels * (digits + 1);
+
+    return chars + chars / LINE_LENGTH + 8;
+  }
+
+  // formats the row i as ASCII samples in to dst and returns the amount of
+  // characters - a line is broken once it reached LINE_LENGTH characters and
+  // at the end of the row
+  template <typename T>
+  std::size_t format_ascii_row(const Image<T> &pic,
+                               const unsigned int &i,
+                               const unsigned int &max,
+                               const bool &separated,
+                               char *dst) {
+    unsigned int cols = pic.get_col_length();
+    unsigned char channels = pic.get_channels();
+    unsigned int line_length = 0;
+    char *start = dst;
+
+    // P1 - a digit per sample
+    if(max == 1 && !separated && channels == 1) {
+      const T *row = pic.get_plane(0).get_row(i);
+
+      for(unsigned int j = 0; j < cols; ++j) {
+        *dst++ = '0' + get_sample(row[j], 1);
+
+        if(++line_length >= LINE_LENGTH) {
+          *dst++ = '\n';
+          line_length = 0;
+        }
+      }
+      if(line_length != 0) {
+        *dst++ = '\n';
+      }
+      return dst - start;
+    }
+
+    for(unsigned int j = 0; j < cols; ++j) {
+      for(unsigned char c = 0; c < channels; ++c) {
+        unsigned int length = format(
+            get_sample(pic.get_plane(c).get_row(i)[j], max), dst);
+
+        length += separated ? 1 : 0;
+        dst += length;
+        line_length += length;
+
+        if(line_length >= LINE_LENGTH) {
+          *dst++ = '\n';
+          line_length = 0;
+        }
+      }
+    }
+    if(line_length != 0) {
+      *dst++ = '\n';
+    }
+    return dst - start;
+  }
+
+  // P1 / P2 / P3 - the samples as decimal numbers, followed by a space if
+  // separated; every row starts a new line. The rows are formatted in bands
+  // on the default ThreadPool and appended in order.
+  template <typename T>
+  void write_ascii(OutputBuffer &out,
+                   const Image<T> &pic,
+                   const unsigned int &begin,
+                   const unsigned int &end,
+                   const unsigned int &max,
+                   const bool &separated) {
+    std::size_t bound = get_ascii_bound(pic.get_col_length(),
+                                        pic.get_channels(), max);
+    unsigned int rows = end - begin;
+    unsigned int band = MatrixExprDetail::get_band_rows(
+        rows, pic.get_col_length() * pic.get_channels());
+
+    if(band >= rows) {
+      for(unsigned int i = begin; i < end; ++i) {
+        out.advance(format_ascii_row(pic, i, max, separated,
+                                     out.get_space(bound)));
+      }
+      return;
+    }
+    unsigned int bands = (rows + band - 1) / band;
+    std::vector<std::vector<char> > buffers(
+        std::min(bands, ASCII_BANDS_PER_PASS));
+
+    for(unsigned int first = 0; first < bands; first += buffers.size()) {
+      unsigned int count = std::min<unsigned int>(buffers.size(),
+                                                  bands - first);
+
+      ThreadPool::get_default().parallel_for(count, 1,
+          [&](unsigned int b_begin, unsigned int b_end) {
+            for(unsigned int b = b_begin; b < b_end; ++b) {
+              unsigned int row = begin + (first + b) * band;
+              unsigned int row_end = std::min(end, row + band);
+              std::vector<char> &buffer = buffers[b];
+              std::size_t used = 0;
+
+              buffer.resize(bound * (row_end - row));
+
+              for(; row < row_end; ++row) {
+                used += format_ascii_row(pic, row, max, separated,
+                                         &buffer[used]);
+              }
+              buffer.resize(used);
+            }
+          });
+
+      for(unsigned int b = 0; b < count; ++b) {
+        if(!buffers[b].empty()) {
+          out.append(&buffers[b][0], buffers[b].size());
+        }
+      }
+    }
+  }
+}
+#endif
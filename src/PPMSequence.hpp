@@ -0,0 +1,238 @@
+#ifndef PPM_SEQUENCE_HPP
+#define PPM_SEQUENCE_HPP
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "PPMFile.hpp"
+#include "PPMTokenizer.hpp"
+
+/**
+ * The PPMSequence class reads a file that holds several ppm pictures one
+ * after an other, e.g. the frames of a camera. Whitespace between the frames
+ * is skipped; every frame has a header of its own, so the format and size may
+ * change from frame to frame.
+ *
+ * The frames are read one after an other by read_next(). build_index() finds
+ * the offsets of all frames in one pass over the headers - only the bodies of
+ * ASCII frames are scanned - after which get_frame() reads any frame. As the
+ * file is mapped read only, get_frame() may be called from several threads
+ * at once.
+ *
+ * P4 rows are padded to whole bytes as the format demands.
+ */
+template <typename T> class PPMSequence : protected PPMFile<T> {
+ public:
+  /**
+   * Maps the file - the frames are read by read_next() or get_frame()
+   *
+   * @param filename is the full path to the file that shall be read
+   */
+  explicit PPMSequence(const std::string &filename) {
+    try {
+      file_ = new MappedFile(filename);
+    } catch(const MappedFileExce::CouldNotMap &e) {
+      throw PPMFileExce::UnexpectedFileEnd("The file wasn't open ...");
+    }
+    data_ = reinterpret_cast<const unsigned char *>(file_->get_data());
+    size_ = file_->get_size();
+    pos_ = skip_space(0);
+    released_ = 0;
+    indexed_ = false;
+  }
+
+  ~PPMSequence() {
+    delete file_;
+  }
+
+  /**
+   * @return true if all frames were read by read_next()
+   */
+  inline bool is_done() const {
+    return pos_ >= size_;
+  }
+
+  /**
+   * Reads the frame after the one read before
+   *
+   * @param frame the picture the frame is stored in
+   * @return      false if there was no frame left
+   */
+  bool read_next(PPMFile<T> &frame) {
+    if(is_done()) {
+      return false;
+    }
+    std::size_t end = find_frame_end(pos_);
+
+    frame = PPMFile<T>(*file_, pos_, end);
+    pos_ = skip_space(end);
+
+    // the frame is done - its bytes are not needed any more
+    file_->advise(released_, pos_ - released_, MappedFile::DONT_NEED);
+    released_ = pos_;
+    return true;
+  }
+
+  /**
+   * Finds the offsets of all frames in one pass - the frames that were read by
+   * read_next() are indexed, too
+   */
+  void build_index() {
+    if(indexed_) {
+      return;
+    }
+    std::size_t pos = skip_space(0);
+
+    offsets_.clear();
+    ends_.clear();
+
+    while(pos < size_) {
+      offsets_.push_back(pos);
+      pos = find_frame_end(pos);
+      ends_.push_back(pos);
+      pos = skip_space(pos);
+    }
+    indexed_ = true;
+  }
+
+  /**
+   * @return true if build_index() was called
+   */
+  inline bool has_index() const {
+    return indexed_;
+  }
+
+  /**
+   * @return the amount of frames - 0 before build_index() was called
+   */
+  inline std::size_t get_frame_count() const {
+    return offsets_.size();
+  }
+
+  /**
+   * @return the positions the headers of the frames start at
+   */
+  inline const std::vector<std::size_t> &get_offsets() const {
+    return offsets_;
+  }
+
+  /**
+   * Reads one frame of the index - build_index() has to be called before
+   *
+   * @param index the number of the frame, starting at 0
+   * @return      the picture of the frame
+   */
+  PPMFile<T> get_frame(const std::size_t &index) const {
+    if(index >= offsets_.size()) {
+      std::ostringstream ss;
+      ss << "Frame " << index << " was requested, the index holds "
+      << offsets_.size() << " frames";
+      throw std::out_of_range(ss.str());
+    }
+    return PPMFile<T>(*file_, offsets_[index], ends_[index]);
+  }
+
+ private:
+  PPMSequence(const PPMSequence &);
+  PPMSequence &operator=(const PPMSequence &);
+
+  // returns the position of the first character at or after pos that is no
+  // whitespace
+  std::size_t skip_space(std::size_t pos) const {
+    const unsigned char *classes = PPMTokenizer::get_table().classes;
+
+    while(pos < size_ && classes[data_[pos]] == PPMTokenizer::SPACE) {
+      ++pos;
+    }
+    return pos;
+  }
+
+  // parses the header of the frame at pos and returns the position after its
+  // body
+  std::size_t find_frame_end(std::size_t pos) {
+    unsigned int width = 0;
+    unsigned int height = 0;
+
+    this->magic_number_ = 0;
+    this->color_depth_ = 0;
+    this->read_header(data_, size_, pos, width, height);
+
+    if(this->magic_number_ == 0) {
+      throw PPMFileExce::BadHeader("No Magic Number");
+    }
+    std::size_t values = (std::size_t)width * height * this->get_subpixels();
+
+    if(this->magic_number_ < 4) {
+      return skip_ascii(pos, values);
+    }
+    std::size_t bytes;
+
+    if(this->magic_number_ == 4) {
+      bytes = (std::size_t)(width + 7) / 8 * height;
+    } else {
+      bytes = values * ((this->color_depth_ > 255) ? 2 : 1);
+    }
+
+    if(size_ - pos < bytes) {
+      std::ostringstream ss;
+      ss << "The file End was at Pos: " << size_ << " while the frame at Pos: "
+      << pos << " needs " << bytes << " bytes";
+
+      throw PPMFileExce::UnexpectedFileEnd(ss.str());
+    }
+    return pos + bytes;
+  }
+
+  // returns the position after the last of the values of an ASCII body
+  std::size_t skip_ascii(std::size_t pos, const std::size_t &values) const {
+    const unsigned char *classes = PPMTokenizer::get_table().classes;
+    bool single_digits = this->magic_number_ == 1;
+
+    for(std::size_t found = 0; found < values; ++found) {
+      while(pos < size_ && classes[data_[pos]] != PPMTokenizer::DIGIT) {
+        if(classes[data_[pos]] == PPMTokenizer::SPACE) {
+          ++pos;
+        } else if(classes[data_[pos]] == PPMTokenizer::COMMENT) {
+          while(pos < size_ && data_[pos] != '\n') {
+            ++pos;
+          }
+        } else {
+          std::ostringstream ss;
+          ss << "The unallowed character was: " << data_[pos] << " at Pos: "
+          << pos;
+          throw PPMFileExce::BadHeader(ss.str());
+        }
+      }
+
+      if(pos >= size_) {
+        std::ostringstream ss;
+        ss << "The file End was at Pos: " << pos << " after " << found
+        << " of " << values << " values of a frame";
+
+        throw PPMFileExce::UnexpectedFileEnd(ss.str());
+      }
+
+      if(single_digits) {
+        ++pos;
+      } else {
+        while(pos < size_ && classes[data_[pos]] == PPMTokenizer::DIGIT) {
+          ++pos;
+        }
+      }
+    }
+    return pos;
+  }
+
+  MappedFile *file_;
+  const unsigned char *data_;
+  std::size_t size_;
+  std::size_t pos_;
+  std::size_t released_;
+  bool indexed_;
+  std::vector<std::size_t> offsets_;
+  std::vector<std::size_t> ends_;
+};
+#endif
@@ -0,0 +1,395 @@
+#ifndef PPM_STREAM_HPP
+#define PPM_STREAM_HPP
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "Image.hpp"
+#include "MappedFile.hpp"
+#include "OutputBuffer.hpp"
+#include "PPMFile.hpp"
+#include "PPMFormat.hpp"
+#include "PPMTokenizer.hpp"
+
+///////////////////////////////////
+//           PPMReader           //
+///////////////////////////////////
+
+/**
+ * The PPMReader class reads a ppm file in bands of rows instead of all at once,
+ * e.g. the 8 row stripes of the DCT. The file is mapped and the bytes of the
+ * rows that were read are dropped from the memory again, so a file of any size
+ * is read with memory for one band - the kernel reads ahead while a band is
+ * processed.
+ *
+ * P4 rows are padded to whole bytes as the format demands.
+ */
+template <typename T> class PPMReader : protected PPMFile<T> {
+ public:
+  using PPMFile<T>::get_magic_number;
+  using PPMFile<T>::get_color_depth;
+  using PPMFile<T>::get_subpixels;
+
+  /**
+   * Reads the header of the file - the rows are read by read_rows()
+   *
+   * @param filename is the full path to the file that shall be read
+   */
+  explicit PPMReader(const std::string &filename) {
+    try {
+      file_ = new MappedFile(filename);
+    } catch(const MappedFileExce::CouldNotMap &e) {
+      throw PPMFileExce::UnexpectedFileEnd("The file wasn't open ...");
+    }
+    data_ = reinterpret_cast<const unsigned char *>(file_->get_data());
+    size_ = file_->get_size();
+    pos_ = 0;
+    released_ = 0;
+    rows_ = 0;
+    cols_ = 0;
+    next_row_ = 0;
+    file_->advise(0, size_, MappedFile::SEQUENTIAL);
+
+    try {
+      this->read_header(data_, size_, pos_, cols_, rows_);
+
+      if(this->magic_number_ == 0) {
+        throw PPMFileExce::BadHeader("No Magic Number");
+      }
+      if(sizeof(T) < 2 && this->color_depth_ > 255) {
+        throw PPMFileExce::BadDataType();
+      }
+    } catch(...) {
+      delete file_;
+      throw;
+    }
+  }
+
+  ~PPMReader() {
+    delete file_;
+  }
+
+  /**
+   * @return the amount of rows of the picture
+   */
+  inline unsigned int get_row_length() const {
+    return rows_;
+  }
+
+  /**
+   * @return the amount of columns of the picture
+   */
+  inline unsigned int get_col_length() const {
+    return cols_;
+  }
+
+  /**
+   * @return the row the next band starts at
+   */
+  inline unsigned int get_next_row() const {
+    return next_row_;
+  }
+
+  /**
+   * @return true if all rows were read
+   */
+  inline bool is_done() const {
+    return next_row_ >= rows_;
+  }
+
+  /**
+   * Reads the next rows of the picture in to band - band is resized to the
+   * rows that were read, a band of the right size is reused
+   *
+   * @param band the image the rows are stored in
+   * @param rows the amount of rows to read - less are read at the end
+   * @return     the amount of rows that were read, 0 if all were read before
+   */
+  unsigned int read_rows(Image<T> &band, const unsigned int &rows) {
+    unsigned int count = std::min(rows, rows_ - next_row_);
+    unsigned char channels = get_subpixels();
+
+    if(band.get_row_length() != count || band.get_col_length() != cols_
+       || band.get_channels() != channels) {
+      band = Image<T>(count, cols_, channels);
+    }
+
+    if(this->magic_number_ < 4) {
+      read_ascii(band);
+    } else {
+      read_binary(band);
+    }
+    next_row_ += count;
+
+    // the rows are done - their bytes are not needed any more
+    if(pos_ > released_) {
+      file_->advise(released_, pos_ - released_, MappedFile::DONT_NEED);
+      released_ = pos_;
+    }
+    return count;
+  }
+
+ private:
+  PPMReader(const PPMReader &);
+  PPMReader &operator=(const PPMReader &);
+
+  // reads the rows of a binary body - the length is checked once per band
+  void read_binary(Image<T> &band) {
+    unsigned char channels = band.get_channels();
+    unsigned int bytes = (this->color_depth_ > 255) ? 2 : 1;
+    std::size_t row_bytes = (this->magic_number_ == 4)
+                            ? (cols_ + 7) / 8
+                            : (std::size_t)cols_ * channels * bytes;
+    std::size_t band_bytes = row_bytes * band.get_row_length();
+
+    if(size_ - pos_ < band_bytes) {
+      std::ostringstream ss;
+      ss << "The file End was at Pos: " << size_ << " while reading row "
+      << next_row_;
+
+      throw PPMFileExce::UnexpectedFileEnd(ss.str());
+    }
+
+    for(unsigned int i = 0; i < band.get_row_length(); ++i) {
+      const unsigned char *src = data_ + pos_ + i * row_bytes;
+
+      if(this->magic_number_ == 4) {
+        PPMFormat::read_bits(src, band, i);
+      } else if(bytes == 1) {
+        PPMFormat::read_bytes(src, band, i);
+      } else {
+        PPMFormat::read_words(src, band, i);
+      }
+    }
+    pos_ += band_bytes;
+  }
+
+  // reads the rows of an ASCII body
+  void read_ascii(Image<T> &band) {
+    for(unsigned int i = 0; i < band.get_row_length(); ++i) {
+      for(unsigned int j = 0; j < cols_; ++j) {
+        for(unsigned char c = 0; c < band.get_channels(); ++c) {
+          band(i, j, c) = next_value();
+        }
+      }
+    }
+  }
+
+  // returns the next value of an ASCII body - whitespace and comments are
+  // skipped, a P1 value is a single digit. The characters are classified by
+  // the table of PPMTokenizer like PPMSequence::skip_ascii does
+  unsigned int next_value() {
+    const unsigned char *classes = PPMTokenizer::get_table().classes;
+
+    while(pos_ < size_ && classes[data_[pos_]] != PPMTokenizer::DIGIT) {
+      if(classes[data_[pos_]] == PPMTokenizer::SPACE) {
+        ++pos_;
+      } else if(classes[data_[pos_]] == PPMTokenizer::COMMENT) {
+        while(pos_ < size_ && data_[pos_] != '\n') {
+          ++pos_;
+        }
+      } else {
+        std::ostringstream ss;
+        ss << "The unallowed character was: " << data_[pos_] << " at Pos: "
+        << pos_;
+        throw PPMFileExce::BadHeader(ss.str());
+      }
+    }
+
+    if(pos_ >= size_) {
+      std::ostringstream ss;
+      ss << "The file End was at Pos: " << pos_ << " while reading row "
+      << next_row_;
+
+      throw PPMFileExce::UnexpectedFileEnd(ss.str());
+    }
+
+    if(this->magic_number_ == 1) {
+      return data_[pos_++] - '0';
+    }
+    unsigned int value = 0;
+
+    while(pos_ < size_ && classes[data_[pos_]] == PPMTokenizer::DIGIT) {
+      value = value * 10 + (data_[pos_++] - '0');
+    }
+    return value;
+  }
+
+  MappedFile *file_;
+  const unsigned char *data_;
+  std::size_t size_;
+  std::size_t pos_;
+  std::size_t released_;
+  unsigned int rows_;
+  unsigned int cols_;
+  unsigned int next_row_;
+};
+
+///////////////////////////////////
+//           PPMWriter           //
+///////////////////////////////////
+
+/**
+ * The PPMWriter class writes a ppm file in bands of rows - the header is
+ * written at once and the bands go through an OutputBuffer, so a picture of
+ * any size is written with memory for one buffer. The bytes are the ones
+ * PPMFile::write_to() writes, except that the samples are clamped to
+ * [0, color depth].
+ */
+template <typename T> class PPMWriter {
+ public:
+  /**
+   * Creates the file and writes the header
+   *
+   * @param filename     is the full path to the file that shall be written
+   * @param rows         the amount of rows of the picture
+   * @param cols         the amount of columns of the picture
+   * @param magic_number the format of the file - 1 to 7
+   * @param color_depth  the maximal value of a subpixel
+   * @param channels     the subpixels of a PAM file (P7) - 1 to 4, the other
+   *                     formats take them from the magic number
+   */
+  PPMWriter(const std::string &filename,
+            const unsigned int &rows,
+            const unsigned int &cols,
+            const unsigned char &magic_number,
+            const unsigned int &color_depth,
+            const unsigned char &channels = 1)
+      : out_(check_arguments(filename, magic_number, color_depth, channels)) {
+    rows_ = rows;
+    cols_ = cols;
+    magic_number_ = magic_number;
+    color_depth_ = get_color_depth(magic_number, color_depth);
+    channels_ = get_channels(magic_number, channels);
+    next_row_ = 0;
+
+    if(magic_number_ == 7) {
+      PPMFormat::write_pam_header(out_, cols_, rows_, channels_, color_depth_,
+                                  PPMFormat::get_tuple_type(channels_,
+                                                            color_depth_));
+    } else {
+      PPMFormat::write_header(out_, magic_number_, cols_, rows_, color_depth_);
+    }
+  }
+
+  /**
+   * @return the row the next band starts at
+   */
+  inline unsigned int get_next_row() const {
+    return next_row_;
+  }
+
+  /**
+   * Writes all rows of band after the rows written before
+   *
+   * @param band the rows to write - it needs the columns and channels of the
+   *             picture
+   */
+  void write_rows(const Image<T> &band) {
+    unsigned char channels = channels_;
+    unsigned int rows = band.get_row_length();
+
+    if(band.get_col_length() != cols_ || band.get_channels() != channels
+       || rows > rows_ - next_row_) {
+      std::ostringstream ss;
+      ss << "The band does not fit the picture. Band:\nRows: " << rows
+      << "\tCols: " << band.get_col_length() << "\tChannels: "
+      << (int)band.get_channels() << "\nPicture:\nRows left: "
+      << rows_ - next_row_ << "\tCols: " << cols_ << "\tChannels: "
+      << (int)channels << "\n";
+      throw std::range_error(ss.str());
+    }
+
+    switch(magic_number_) {
+    case 1:
+    case 2:
+    case 3:
+      PPMFormat::write_ascii(out_, band, 0, rows, color_depth_,
+                             magic_number_ != 1);
+      break;
+    case 4:
+      PPMFormat::write_bits(out_, band, 0, rows);
+      break;
+    default:
+      if(color_depth_ > 255) {
+        PPMFormat::write_words(out_, band, 0, rows, color_depth_);
+      } else {
+        PPMFormat::write_bytes(out_, band, 0, rows, color_depth_);
+      }
+    }
+    next_row_ += rows;
+  }
+
+  /**
+   * Flushes and closes the file
+   *
+   * @throws OutputBufferExce::CouldNotWrite if not all rows were written
+   */
+  void close() {
+    out_.close();
+
+    if(next_row_ != rows_) {
+      std::ostringstream ss;
+      ss << "Only " << next_row_ << " of " << rows_ << " rows were written";
+      throw OutputBufferExce::CouldNotWrite(ss.str());
+    }
+  }
+
+ private:
+  PPMWriter(const PPMWriter &);
+  PPMWriter &operator=(const PPMWriter &);
+
+  // the maximal value of a subpixel - the bitmaps have 1
+  static unsigned int get_color_depth(const unsigned char &magic_number,
+                                      const unsigned int &color_depth) {
+    return (magic_number == 1 || magic_number == 4) ? 1 : color_depth;
+  }
+
+  // the subpixels of a pixel - only PAM files (P7) take them as given
+  static unsigned char get_channels(const unsigned char &magic_number,
+                                    const unsigned char &channels) {
+    if(magic_number == 7) {
+      return channels;
+    }
+    return (magic_number == 3 || magic_number == 6) ? 3 : 1;
+  }
+
+  // throws if the header would be bad - it runs before out_ is opened, so a
+  // bad header leaves an existing file untouched
+  static const std::string &check_arguments(const std::string &filename,
+                                            const unsigned char &magic_number,
+                                            const unsigned int &color_depth,
+                                            const unsigned char &channels) {
+    if(magic_number < 1 || magic_number > 7) {
+      std::ostringstream ss;
+      ss << "Magic number was: " << (int)magic_number;
+      throw PPMFileExce::BadHeader(ss.str());
+    }
+    unsigned char depth = get_channels(magic_number, channels);
+
+    if(depth < 1 || depth > 4) {
+      std::ostringstream ss;
+      ss << "Depth was: " << (int)depth << " - 1 to 4 are supported";
+      throw PPMFileExce::BadHeader(ss.str());
+    }
+    unsigned int max_value = get_color_depth(magic_number, color_depth);
+
+    if(max_value < 1 || max_value > 65535) {
+      std::ostringstream ss;
+      ss << "Color depth was: " << max_value;
+      throw PPMFileExce::BadHeader(ss.str());
+    }
+    return filename;
+  }
+
+  OutputBuffer out_;
+  unsigned int rows_;
+  unsigned int cols_;
+  unsigned char magic_number_;
+  unsigned char channels_;
+  unsigned int color_depth_;
+  unsigned int next_row_;
+};
+#endif
@@ -0,0 +1,293 @@
+#ifndef PPM_TOKENIZER_HPP
+#define PPM_TOKENIZER_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Tokenizer for the bodies of ASCII ppm files (P1, P2 and P3). The values are
+ * unsigned decimal numbers separated by whitespace, a '#' starts a comment
+ * that ends with the line.
+ *
+ * Every character is classified by a lookup table. With SSE2 16 characters are
+ * classified at once; a block of only digits and whitespace is split in to
+ * tokens by its digit mask, so the scalar path only runs for comments and the
+ * tail. The values are handed to a sink one after an other - sink(value).
+ *
+ * A large body can be split in to chunks that are scanned independently -
+ * count() the values of every chunk, then the sum of the counts before a chunk
+ * is the index of its first value.
+ */
+namespace PPMTokenizer {
+  enum CharClass { OTHER = 0, DIGIT = 1, SPACE = 2, COMMENT = 3 };
+
+  // the least amount of characters of a chunk
+  const std::size_t CHUNK_BYTES = 1 << 20;
+
+  // the class of every character
+  struct ClassTable {
+    ClassTable() {
+      for(unsigned int c = 0; c < 256; ++c) {
+        classes[c] = OTHER;
+      }
+      for(unsigned int c = '0'; c <= '9'; ++c) {
+        classes[c] = DIGIT;
+      }
+      classes[(unsigned char)' '] = SPACE;
+      classes[(unsigned char)'\t'] = SPACE;
+      classes[(unsigned char)'\n'] = SPACE;
+      classes[(unsigned char)'\v'] = SPACE;
+      classes[(unsigned char)'\f'] = SPACE;
+      classes[(unsigned char)'\r'] = SPACE;
+      classes[0] = SPACE;
+      classes[(unsigned char)'#'] = COMMENT;
+    }
+
+    unsigned char classes[256];
+  };
+
+  inline const ClassTable &get_table() {
+    static const ClassTable table;
+    return table;
+  }
+
+#ifdef __SSE2__
+  // sets the bits of the digits and of the characters that are neither digits
+  // nor whitespace of the 16 characters at data
+  inline void classify(const unsigned char *data,
+                       unsigned int &digits,
+                       unsigned int &others) {
+    const __m128i bias = _mm_set1_epi8((char)0x80);
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+
+    // c - '0' < 10 and c - '\t' < 5 as unsigned compares
+    __m128i digit = _mm_cmplt_epi8(
+        _mm_xor_si128(_mm_sub_epi8(v, _mm_set1_epi8('0')), bias),
+        _mm_set1_epi8((char)(0x80 + 10)));
+    __m128i space = _mm_or_si128(
+        _mm_cmplt_epi8(_mm_xor_si128(_mm_sub_epi8(v, _mm_set1_epi8('\t')), bias),
+                       _mm_set1_epi8((char)(0x80 + 5))),
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                     _mm_cmpeq_epi8(v, _mm_setzero_si128())));
+
+    digits = _mm_movemask_epi8(digit);
+    others = ~(digits | _mm_movemask_epi8(space)) & 0xFFFF;
+  }
+#endif
+
+  /**
+   * Hands every value in [pos, end) to the sink. A value that reaches end is
+   * complete - end has to be a whitespace boundary.
+   *
+   * @param data          the characters
+   * @param pos           the first character to scan
+   * @param end           the character after the last one to scan
+   * @param single_digits true if every digit is a value of its own (P1)
+   * @param sink          is called with every value in order
+   * @return              end or the position of the first character that is
+   *                      not allowed in a body
+   */
+  template <typename Sink>
+  std::size_t scan(const unsigned char *data,
+                   std::size_t pos,
+                   const std::size_t &end,
+                   const bool &single_digits,
+                   Sink &sink) {
+    const unsigned char *classes = get_table().classes;
+    unsigned int value = 0;
+    bool in_token = false;
+    std::size_t scalar_end = pos;
+
+    while(pos < end) {
+#ifdef __SSE2__
+      if(pos >= scalar_end && end - pos >= 16) {
+        unsigned int digits;
+        unsigned int others;
+
+        classify(data + pos, digits, others);
+
+        if(others != 0) {
+          // the block is scanned character by character up to the comment or
+          // the bad character
+          scalar_end = pos + __builtin_ctz(others) + 1;
+        } else if(single_digits) {
+          for(; digits != 0; digits &= digits - 1) {
+            sink(data[pos + __builtin_ctz(digits)] - '0');
+          }
+          pos += 16;
+          continue;
+        } else {
+          unsigned int i = 0;
+
+          while(i < 16) {
+            unsigned int rest = digits >> i;
+
+            if((rest & 1) == 0) {
+              if(in_token) {
+                sink(value);
+                value = 0;
+                in_token = false;
+              }
+              if(rest == 0) {
+                break;
+              }
+              i += __builtin_ctz(rest);
+              rest = digits >> i;
+            }
+            unsigned int run_end = i + __builtin_ctz(~rest);
+
+            for(; i < run_end; ++i) {
+              value = value * 10 + (data[pos + i] - '0');
+            }
+            in_token = true;
+          }
+          pos += 16;
+          continue;
+        }
+      }
+#endif
+      unsigned char c = data[pos];
+
+      switch(classes[c]) {
+      case DIGIT:
+        if(single_digits) {
+          sink(c - '0');
+        } else {
+          value = value * 10 + (c - '0');
+          in_token = true;
+        }
+        ++pos;
+        break;
+      case SPACE:
+        if(in_token) {
+          sink(value);
+          value = 0;
+          in_token = false;
+        }
+        ++pos;
+        break;
+      case COMMENT:
+        if(in_token) {
+          sink(value);
+          value = 0;
+          in_token = false;
+        }
+        while(pos < end && data[pos] != '\n') {
+          ++pos;
+        }
+        break;
+      default:
+        return pos;
+      }
+    }
+
+    if(in_token) {
+      sink(value);
+    }
+    return end;
+  }
+
+  /**
+   * Counts the values in [pos, end) without reading them - with SSE2 the
+   * values of a block are the digits that do not follow a digit.
+   *
+   * @param values is increased by the amount of values
+   * @return       end or the position of the first character that is not
+   *               allowed in a body
+   */
+  inline std::size_t count(const unsigned char *data,
+                           std::size_t pos,
+                           const std::size_t &end,
+                           const bool &single_digits,
+                           std::size_t &values) {
+    const unsigned char *classes = get_table().classes;
+    bool in_token = false;
+    std::size_t scalar_end = pos;
+
+    while(pos < end) {
+#ifdef __SSE2__
+      if(pos >= scalar_end && end - pos >= 16) {
+        unsigned int digits;
+        unsigned int others;
+
+        classify(data + pos, digits, others);
+
+        if(others != 0) {
+          scalar_end = pos + __builtin_ctz(others) + 1;
+        } else {
+          unsigned int starts = single_digits
+                                ? digits
+                                : digits & ~((digits << 1) | in_token);
+
+          values += __builtin_popcount(starts);
+          in_token = !single_digits && (digits >> 15) != 0;
+          pos += 16;
+          continue;
+        }
+      }
+#endif
+      switch(classes[data[pos]]) {
+      case DIGIT:
+        if(single_digits || !in_token) {
+          ++values;
+        }
+        in_token = !single_digits;
+        ++pos;
+        break;
+      case SPACE:
+        in_token = false;
+        ++pos;
+        break;
+      case COMMENT:
+        in_token = false;
+
+        while(pos < end && data[pos] != '\n') {
+          ++pos;
+        }
+        break;
+      default:
+        return pos;
+      }
+    }
+    return end;
+  }
+
+  /**
+   * Splits the body [pos, end) in to chunks of at least chunk_bytes
+   * characters. A chunk starts after a newline - or after any whitespace if
+   * the body has no comment - so no chunk starts within a token or a comment.
+   * The chunks only depend on the characters, not on the amount of threads.
+   *
+   * @return the positions the chunks start at followed by end
+   */
+  inline std::vector<std::size_t> split(const unsigned char *data,
+                                        const std::size_t &pos,
+                                        const std::size_t &end,
+                                        const std::size_t &chunk_bytes) {
+    const unsigned char *classes = get_table().classes;
+    bool comments = pos < end
+                    && std::memchr(data + pos, '#', end - pos) != NULL;
+    std::vector<std::size_t> bounds(1, pos);
+
+    while(end - bounds.back() > chunk_bytes) {
+      std::size_t bound = bounds.back() + chunk_bytes;
+
+      while(bound < end && (comments ? data[bound - 1] != '\n'
+                                     : classes[data[bound - 1]] != SPACE)) {
+        ++bound;
+      }
+      if(bound >= end) {
+        break;
+      }
+      bounds.push_back(bound);
+    }
+    bounds.push_back(end);
+    return bounds;
+  }
+}
+#endif
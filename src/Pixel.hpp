@@ -6,12 +6,67 @@
 #include <sstream>
 #include <math.h>
 #include <limits>
+#include <array>
+
+/**
+ * Clamp policies of a Pixel - every value that is written in to a subpixel
+ * passes Clamp::apply first. The policy is a template parameter, so a Pixel
+ * that does not clamp does not pay for it.
+ */
+namespace PixelClamp {
+  // the values are stored as they are
+  struct None {
+    template <typename T>
+    static inline T apply(const T &value) {
+      return value;
+    }
+  };
+
+  // infinite values become the maximum and NaN the minimum of T
+  struct Validate {
+    template <typename T>
+    static inline T apply(const T &value) {
+      if(isinf(value)) {
+        return std::numeric_limits<T>::max();
+      } else if(isnan(value)) {
+        return std::numeric_limits<T>::min();
+      }
+      return value;
+    }
+  };
+
+  // the values saturate at Min and Max, e.g. Range<0, 255> for 8 bit colours
+  template <long Min, long Max>
+  struct Range {
+    template <typename T>
+    static inline T apply(const T &value) {
+      if(value > Max) {
+        return Max;
+      } else if(value < Min) {
+        return Min;
+      }
+      return value;
+    }
+  };
+}
+
+/**
+ * A Pixel with N subpixels that are stored inline - see the class below for
+ * N = 0, the Pixel with a runtime amount of subpixels.
+ */
+template <typename T,
+          unsigned int N = 0,
+          typename Clamp = PixelClamp::Validate>
+class Pixel;
 
 /**
  * The Pixel class is used to represent a Pixel, with subpixels for e.g. RGB
  * it implements all mathematical operations and compare operations.
+ *
+ * This is the Pixel with a runtime amount of subpixels on the heap - the
+ * operations check that both pixels have the same size.
  */
-template <typename T> class Pixel {
+template <typename T, typename Clamp> class Pixel<T, 0, Clamp> {
 public:
   /**
    * Default constructor
@@ -24,7 +79,7 @@ public:
   /**
    * Copy Constructor
    */
-  Pixel(const Pixel<T> &copy) {
+  Pixel(const Pixel &copy) {
     size_ = copy.size();
     pixel_ = new T[size_]();
 
@@ -33,6 +88,16 @@ public:
     }
   }
 
+  /**
+   * Move Constructor - takes over the subpixels of other, other will be empty
+   */
+  Pixel(Pixel &&other) noexcept {
+    size_ = other.size_;
+    pixel_ = other.pixel_;
+    other.size_ = 0;
+    other.pixel_ = NULL;
+  }
+
   /**
    * Constructor with a defined amount of subpixels
    *
@@ -70,8 +135,8 @@ public:
   /**
    * @return returns the Pixels average gray value 
    */
-  inline Pixel<T> get_grey() const {
-    Pixel<T> p = Pixel<T>(*this);
+  inline Pixel get_grey() const {
+    Pixel p = Pixel(*this);
     
     p.grey();
 
@@ -82,7 +147,7 @@ public:
    * @return returns a reference to the calling object, the object has only one
    * subpixel that has the value of the average gray value
    */
-  Pixel<T> &grey() {
+  Pixel &grey() {
     T *del = pixel_;
     pixel_ = new T[1]();
     
@@ -145,7 +210,7 @@ public:
    * if the size of the left hand side object is 0 the right hand side 
    * else the size of both pixels has to be the same
    */
-  Pixel<T> operator+=(const Pixel<T> &rhs) {
+  Pixel &operator+=(const Pixel &rhs) {
     if(size_ == rhs.size()) {
       for(unsigned char i = 0; i < size_; ++i) {
         pixel_[i] += rhs.get_pixel(i);
@@ -180,7 +245,7 @@ public:
    * if the size of the left hand side object is 0 the right hand side 
    * else the size of both pixels has to be the same
    */
-  inline friend const Pixel<T> operator+(Pixel<T> lhs, const Pixel<T>& rhs) {
+  inline friend Pixel operator+(Pixel lhs, const Pixel& rhs) {
     lhs += rhs;
     return lhs;
   }
@@ -189,7 +254,7 @@ public:
    * Mathematical operation +
    * it additions the subpixels with the value 
    */
-  Pixel<T> operator+=(const T &rhs) {
+  Pixel &operator+=(const T &rhs) {
     for(unsigned char i = 0; i < size_; ++i) {
       pixel_[i] += rhs;
       validate_value(pixel_[i]);
@@ -201,7 +266,7 @@ public:
    * Mathematical operation +
    * it additions the subpixels with the value 
    */
-  inline friend const Pixel<T> operator+(Pixel<T> lhs, const T &rhs) {
+  inline friend Pixel operator+(Pixel lhs, const T &rhs) {
     lhs += rhs;
     return lhs;
   }
@@ -211,7 +276,7 @@ public:
    * if the size of the left hand side object is 0 the right hand side 
    * else the size of both pixels has to be the same
    */
-  Pixel<T> operator-=(const Pixel<T> &rhs) {
+  Pixel &operator-=(const Pixel &rhs) {
     if(size_ == rhs.size()) {
       for(unsigned char i = 0; i < size_; ++i) {
         pixel_[i] -= rhs.get_pixel(i);
@@ -244,7 +309,7 @@ public:
    * if the size of the left hand side object is 0 the right hand side 
    * else the size of both pixels has to be the same
    */
-  inline friend const Pixel<T> operator-(Pixel<T> lhs, const Pixel<T>& rhs) {
+  inline friend Pixel operator-(Pixel lhs, const Pixel& rhs) {
     lhs -= rhs;
     return lhs;
   }
@@ -253,7 +318,7 @@ public:
    * Mathematical operation -
    * it subtracts the subpixels with the value 
    */
-  Pixel<T> operator-=(const T &rhs) {
+  Pixel &operator-=(const T &rhs) {
     for(unsigned char i = 0; i < size_; ++i) {
       pixel_[i] -= rhs;
       validate_value(pixel_[i]);
@@ -265,7 +330,7 @@ public:
    * Mathematical operation -
    * it subtracts the subpixels with the value 
    */
-  inline friend const Pixel<T> operator-(Pixel<T> lhs, const T& rhs) {
+  inline friend Pixel operator-(Pixel lhs, const T& rhs) {
     lhs -= rhs;
     return lhs;
   }
@@ -275,7 +340,7 @@ public:
    * if the size of the left hand side object is 0 the right hand side 
    * else the size of both pixels has to be the same
    */
-  Pixel<T> operator*=(const Pixel<T> &rhs) {
+  Pixel &operator*=(const Pixel &rhs) {
     if(size_ == rhs.size()) {
       for(unsigned char i = 0; i < size_; ++i) {
         pixel_[i] *= rhs.get_pixel(i);
@@ -309,7 +374,7 @@ public:
    * if the size of the left hand side object is 0 the right hand side 
    * else the size of both pixels has to be the same
    */
-  inline friend const Pixel<T> operator*(Pixel<T> lhs, const Pixel<T>& rhs) {
+  inline friend Pixel operator*(Pixel lhs, const Pixel& rhs) {
     lhs *= rhs;
     return lhs;
   }
@@ -318,7 +383,7 @@ public:
    * Mathematical operation *
    * it multiplies the subpixels with the value 
    */
-  Pixel<T> operator*=(const T &rhs) {
+  Pixel &operator*=(const T &rhs) {
     for(unsigned char i = 0; i < size_; ++i) {
       pixel_[i] *= rhs;
       validate_value(pixel_[i]);
@@ -330,7 +395,7 @@ public:
    * Mathematical operation *
    * it multiplies the subpixels with the value 
    */
-  inline friend const Pixel<T> operator*(Pixel<T> lhs, const T& rhs) {
+  inline friend Pixel operator*(Pixel lhs, const T& rhs) {
     lhs *= rhs;
     return lhs;
   }
@@ -340,7 +405,7 @@ public:
    * if the size of the left hand side object is 0 the right hand side 
    * else the size of both pixels has to be the same
    */
-  Pixel<T> operator/=(const Pixel<T> &rhs) {
+  Pixel &operator/=(const Pixel &rhs) {
     if(size_ == rhs.size()) {
       for(unsigned char i = 0; i < size_; ++i) {
         pixel_[i] /= rhs.get_pixel(i);
@@ -374,7 +439,7 @@ public:
    * if the size of the left hand side object is 0 the right hand side 
    * else the size of both pixels has to be the same
    */
-  inline friend const Pixel<T> operator/(Pixel<T> lhs, const Pixel<T>& rhs) {
+  inline friend Pixel operator/(Pixel lhs, const Pixel& rhs) {
     lhs /= rhs;
     return lhs;
   }
@@ -383,7 +448,7 @@ public:
    * Mathematical operation /
    * it divides the subpixels with the value 
    */
-  Pixel<T> operator/=(const T &rhs) {
+  Pixel &operator/=(const T &rhs) {
     for(unsigned char i = 0; i < size_; ++i) {
       pixel_[i] /= rhs;
       validate_value(pixel_[i]);
@@ -394,12 +459,12 @@ public:
    * Mathematical operation /
    * it divides the subpixels with the value 
    */
-  inline friend const Pixel<T> operator/(Pixel<T> lhs, const T& rhs) {
+  inline friend Pixel operator/(Pixel lhs, const T& rhs) {
     lhs /= rhs;
     return lhs;
   }
 
-  bool operator==(const Pixel<T> &rhs) const {
+  bool operator==(const Pixel &rhs) const {
     if(size == rhs.size()) {
       for(unsigned char i = 0; i < size_; ++i) {
         if(pixel_[i] != rhs.get_pixel(i)) {
@@ -411,42 +476,55 @@ public:
     return false;
   }
 
-  bool operator!=(const Pixel<T> &rhs) const {
+  bool operator!=(const Pixel &rhs) const {
     return !(*this == rhs);
   }
 
-  bool operator<(const Pixel<T> &rhs) const {
+  bool operator<(const Pixel &rhs) const {
    return get_grey().get_pixel(0) < rhs.get_grey().get_pixel(0);
   } 
 
-  bool operator>=(const Pixel<T> &rhs) const {
+  bool operator>=(const Pixel &rhs) const {
    return !(*this < rhs);
   }
 
-  bool operator>(const Pixel<T> &rhs) const {
+  bool operator>(const Pixel &rhs) const {
    return get_grey().get_pixel(0) > rhs.get_grey().get_pixel(0);
   }
 
-  bool operator<=(const Pixel<T> &rhs) const {
+  bool operator<=(const Pixel &rhs) const {
    return !(*this > rhs);
   } 
 
-  Pixel operator=(const Pixel& copy) {
+  Pixel &operator=(const Pixel& copy) {
     if(this != &copy) {
-      size_ = copy.size();
+      if(size_ != copy.size()) {
+        T *temp = pixel_;
 
-      T *temp = pixel_;
+        pixel_ = new T[copy.size()]();
+        size_ = copy.size();
+        delete[] temp; 
+      }
 
-      pixel_ = new T[size_]();
       for(unsigned char i = 0; i < size_; ++i) {
-        pixel_[i] = copy.get_pixel(i);
+        pixel_[i] = copy.pixel_[i];
       }
-      delete[] temp; 
     }
     return *this;
   }
 
-  friend std::ostream& operator<<(std::ostream& out, const Pixel<T>& p) {
+  Pixel &operator=(Pixel&& rhs) noexcept {
+    if(this != &rhs) {
+      delete[] pixel_;
+      size_ = rhs.size_;
+      pixel_ = rhs.pixel_;
+      rhs.size_ = 0;
+      rhs.pixel_ = NULL;
+    }
+    return *this;
+  }
+
+  friend std::ostream& operator<<(std::ostream& out, const Pixel& p) {
     out << '(';
     for(unsigned char i = 0; i < p.size(); ++i) {
       if(i != 0) {
@@ -467,13 +545,7 @@ private:
    * @return       returns a valid value
    */
   inline T get_valid_value(T value) const {
-    if(isinf(value)) {
-      return std::numeric_limits<T>::max();
-    } else if(isnan(value)) {
-      return std::numeric_limits<T>::min();
-    } else {
-      return value;
-    }
+    return Clamp::apply(value);
   }
 
   /**
@@ -482,14 +554,229 @@ private:
    * @param value value to be checked / changed
    */
   inline void validate_value(T &value) const {
-    if(isinf(value)) {
-      value = std::numeric_limits<T>::max();
-    } else if(isnan(value)) {
-      value = std::numeric_limits<T>::min();
-    }
+    value = Clamp::apply(value);
   }
 
   unsigned char size_;
   T *pixel_;
 };
+
+/**
+ * The Pixel class with N subpixels that are stored inline in a std::array. A
+ * Pixel<T, N> never touches the heap and the sizes of two pixels are checked
+ * at compile time, so it can be used in inner loops. Every written value
+ * passes the Clamp policy.
+ */
+template <typename T, unsigned int N, typename Clamp> class Pixel {
+public:
+  /**
+   * Default constructor - all subpixels are T()
+   */
+  Pixel() : pixel_() {
+  }
+
+  /**
+   * Constructor with a certain value for all subpixels
+   *
+   * @param val Defines the value for the subpixels
+   */
+  explicit Pixel(const T &val) {
+    pixel_.fill(Clamp::apply(val));
+  }
+
+  /**
+   * @return returns the Pixel with one subpixel that has the average gray
+   *         value
+   */
+  inline Pixel<T, 1, Clamp> get_grey() const {
+    T grey = T();
+
+    for(unsigned int i = 0; i < N; ++i) {
+      grey += pixel_[i] / static_cast<int>(N);
+    }
+    return Pixel<T, 1, Clamp>(grey);
+  }
+
+  /**
+   * @return returns the size of the Pixel - the amount of subpixels
+   */
+  static constexpr unsigned char size() {
+    return N;
+  }
+
+  /**
+   * @param  pixel specifies the number of the subpixel to get e.g 2 to get the
+   *               blue subpixel of RGB
+   *
+   * @return       returns the value of the specified subpixel
+   */
+  inline T get_pixel(const unsigned char &pixel) const {
+    check_subpixel(pixel);
+    return pixel_[pixel];
+  }
+
+  /**
+   * @param  pixel specifies the number of the subpixel to get e.g 2 to get the
+   *               blue subpixel of RGB
+   * @param val   value to be set at the specified subpixel
+   */
+  inline void set_pixel(const unsigned char &pixel, const T &val) {
+    check_subpixel(pixel);
+    pixel_[pixel] = Clamp::apply(val);
+  }
+
+  /**
+   * @return returns the subpixel - unchecked and not clamped
+   */
+  inline T &operator[](const unsigned int &pixel) {
+    return pixel_[pixel];
+  }
+
+  /**
+   * @return returns the subpixel - unchecked
+   */
+  inline const T &operator[](const unsigned int &pixel) const {
+    return pixel_[pixel];
+  }
+
+  Pixel &operator+=(const Pixel &rhs) {
+    for(unsigned int i = 0; i < N; ++i) {
+      pixel_[i] = Clamp::apply(pixel_[i] + rhs.pixel_[i]);
+    }
+    return *this;
+  }
+
+  Pixel &operator-=(const Pixel &rhs) {
+    for(unsigned int i = 0; i < N; ++i) {
+      pixel_[i] = Clamp::apply(pixel_[i] - rhs.pixel_[i]);
+    }
+    return *this;
+  }
+
+  Pixel &operator*=(const Pixel &rhs) {
+    for(unsigned int i = 0; i < N; ++i) {
+      pixel_[i] = Clamp::apply(pixel_[i] * rhs.pixel_[i]);
+    }
+    return *this;
+  }
+
+  Pixel &operator/=(const Pixel &rhs) {
+    for(unsigned int i = 0; i < N; ++i) {
+      pixel_[i] = Clamp::apply(pixel_[i] / rhs.pixel_[i]);
+    }
+    return *this;
+  }
+
+  Pixel &operator+=(const T &rhs) {
+    for(unsigned int i = 0; i < N; ++i) {
+      pixel_[i] = Clamp::apply(pixel_[i] + rhs);
+    }
+    return *this;
+  }
+
+  Pixel &operator-=(const T &rhs) {
+    for(unsigned int i = 0; i < N; ++i) {
+      pixel_[i] = Clamp::apply(pixel_[i] - rhs);
+    }
+    return *this;
+  }
+
+  Pixel &operator*=(const T &rhs) {
+    for(unsigned int i = 0; i < N; ++i) {
+      pixel_[i] = Clamp::apply(pixel_[i] * rhs);
+    }
+    return *this;
+  }
+
+  Pixel &operator/=(const T &rhs) {
+    for(unsigned int i = 0; i < N; ++i) {
+      pixel_[i] = Clamp::apply(pixel_[i] / rhs);
+    }
+    return *this;
+  }
+
+  inline friend Pixel operator+(Pixel lhs, const Pixel &rhs) {
+    return lhs += rhs;
+  }
+
+  inline friend Pixel operator-(Pixel lhs, const Pixel &rhs) {
+    return lhs -= rhs;
+  }
+
+  inline friend Pixel operator*(Pixel lhs, const Pixel &rhs) {
+    return lhs *= rhs;
+  }
+
+  inline friend Pixel operator/(Pixel lhs, const Pixel &rhs) {
+    return lhs /= rhs;
+  }
+
+  inline friend Pixel operator+(Pixel lhs, const T &rhs) {
+    return lhs += rhs;
+  }
+
+  inline friend Pixel operator-(Pixel lhs, const T &rhs) {
+    return lhs -= rhs;
+  }
+
+  inline friend Pixel operator*(Pixel lhs, const T &rhs) {
+    return lhs *= rhs;
+  }
+
+  inline friend Pixel operator/(Pixel lhs, const T &rhs) {
+    return lhs /= rhs;
+  }
+
+  bool operator==(const Pixel &rhs) const {
+    return pixel_ == rhs.pixel_;
+  }
+
+  bool operator!=(const Pixel &rhs) const {
+    return !(*this == rhs);
+  }
+
+  bool operator<(const Pixel &rhs) const {
+    return get_grey()[0] < rhs.get_grey()[0];
+  }
+
+  bool operator>=(const Pixel &rhs) const {
+    return !(*this < rhs);
+  }
+
+  bool operator>(const Pixel &rhs) const {
+    return get_grey()[0] > rhs.get_grey()[0];
+  }
+
+  bool operator<=(const Pixel &rhs) const {
+    return !(*this > rhs);
+  }
+
+  friend std::ostream& operator<<(std::ostream& out, const Pixel& p) {
+    out << '(';
+    for(unsigned int i = 0; i < N; ++i) {
+      if(i != 0) {
+        out << ' ';
+      }
+      out << p.pixel_[i];
+    }
+    out << ')';
+
+    return out;
+  }
+
+private:
+  static_assert(N > 0 && N < 256, "Pixel: 1 up to 255 subpixels");
+
+  inline void check_subpixel(const unsigned char &pixel) const {
+    if(pixel >= N) {
+      std::ostringstream ss;
+      ss << "Subpixel " << (int)pixel << " was requestet from a Pixel of size: "
+      << N << '\n';
+
+      throw std::range_error(ss.str());
+    }
+  }
+
+  std::array<T, N> pixel_;
+};
 #endif
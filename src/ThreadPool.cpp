@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <memory>
+
+#include "ThreadPool.hpp"
+
+namespace {
+  // true while the thread works on a chunk
+  thread_local bool in_chunk = false;
+
+  std::unique_ptr<ThreadPool> &get_default_pool() {
+    static std::unique_ptr<ThreadPool> pool;
+    return pool;
+  }
+}
+
+// starts threads - 1 workers
+ThreadPool::ThreadPool(const unsigned int &threads) {
+  job_ = NULL;
+  generation_ = 0;
+  busy_ = 0;
+  stop_ = false;
+
+  // a thread that could not be started leaves no joinable worker behind
+  try {
+    for(unsigned int i = 1; i < threads; ++i) {
+      workers_.push_back(std::thread(&ThreadPool::run_worker, this));
+    }
+  } catch(...) {
+    stop_workers();
+    throw;
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  stop_workers();
+}
+
+// stops and joins the workers
+void ThreadPool::stop_workers() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  start_.notify_all();
+
+  for(unsigned int i = 0; i < workers_.size(); ++i) {
+    workers_[i].join();
+  }
+}
+
+void ThreadPool::parallel_for(
+    const unsigned int &count,
+    const unsigned int &grain,
+    const std::function<void(unsigned int, unsigned int)> &func) {
+  unsigned int step = (grain == 0) ? 1 : grain;
+  unsigned int chunks = count / step + ((count % step != 0) ? 1 : 0);
+
+  if(chunks <= 1 || workers_.empty() || in_chunk) {
+    for(unsigned int begin = 0; begin < count; begin += step) {
+      func(begin, std::min(count, begin + step));
+    }
+    return;
+  }
+  std::lock_guard<std::mutex> run_lock(run_mutex_);
+  Job job = {&func, count, step, chunks, 0, std::exception_ptr()};
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    job_ = &job;
+    ++generation_;
+  }
+  start_.notify_all();
+
+  work(job);
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    job_ = NULL;
+    done_.wait(lock, [this]() { return busy_ == 0; });
+  }
+
+  if(job.error) {
+    std::rethrow_exception(job.error);
+  }
+}
+
+ThreadPool &ThreadPool::get_default() {
+  std::unique_ptr<ThreadPool> &pool = get_default_pool();
+
+  if(!pool) {
+    pool.reset(new ThreadPool(get_hardware_threads()));
+  }
+  return *pool;
+}
+
+void ThreadPool::set_default_threads(const unsigned int &threads) {
+  get_default_pool().reset(
+      new ThreadPool((threads == 0) ? get_hardware_threads()
+                                    : std::min(threads, get_max_threads())));
+}
+
+unsigned int ThreadPool::get_hardware_threads() {
+  unsigned int threads = std::thread::hardware_concurrency();
+
+  return (threads == 0) ? 1 : threads;
+}
+
+unsigned int ThreadPool::get_max_threads() {
+  return 4 * get_hardware_threads();
+}
+
+// waits for jobs and helps working on them until the pool is stopped
+void ThreadPool::run_worker() {
+  unsigned long seen = 0;
+
+  while(true) {
+    Job *job = NULL;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      start_.wait(lock, [this, seen]() {
+        return stop_ || (job_ != NULL && generation_ != seen);
+      });
+
+      if(stop_) {
+        return;
+      }
+      seen = generation_;
+      job = job_;
+      ++busy_;
+    }
+
+    work(*job);
+
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      --busy_;
+    }
+    done_.notify_one();
+  }
+}
+
+// takes chunks of the job until none is left
+void ThreadPool::work(Job &job) {
+  in_chunk = true;
+
+  while(true) {
+    unsigned int chunk;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      if(job.next >= job.chunks || job.error) {
+        break;
+      }
+      chunk = job.next++;
+    }
+    unsigned int begin = chunk * job.grain;
+
+    try {
+      (*job.func)(begin, std::min(job.count, begin + job.grain));
+    } catch(...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+
+      if(!job.error) {
+        job.error = std::current_exception();
+      }
+    }
+  }
+  in_chunk = false;
+}
@@ -0,0 +1,79 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * The ThreadPool class keeps a fixed amount of worker threads alive and splits
+ * loops over them. A loop of count iterations is cut in to chunks of grain
+ * iterations; the chunks only depend on count and grain, never on the amount
+ * of threads, so a reduction that combines one partial per chunk in chunk
+ * order gives the same result with any amount of threads.
+ *
+ * The thread that calls parallel_for works on the chunks as well. Calls from
+ * inside of a chunk run serially on the calling thread.
+ */
+class ThreadPool {
+ public:
+  // threads is the amount of threads working on a loop - including the caller
+  explicit ThreadPool(const unsigned int &threads);
+
+  ~ThreadPool();
+
+  // calls func(begin, end) for every chunk of [0, count) - returns when all
+  // chunks are done and rethrows the first exception a chunk threw
+  void parallel_for(const unsigned int &count,
+                    const unsigned int &grain,
+                    const std::function<void(unsigned int, unsigned int)> &func);
+
+  inline unsigned int get_threads() const {
+    return workers_.size() + 1;
+  }
+
+  // returns the pool the matrix operations use
+  static ThreadPool &get_default();
+
+  // replaces the default pool - 0 uses one thread per core, more than
+  // get_max_threads() are capped; must not be called while the default pool is
+  // working
+  static void set_default_threads(const unsigned int &threads);
+
+  // returns the amount of threads the hardware can run at once
+  static unsigned int get_hardware_threads();
+
+  // returns the most threads a pool is given - 4 per core
+  static unsigned int get_max_threads();
+
+ private:
+  struct Job {
+    const std::function<void(unsigned int, unsigned int)> *func;
+    unsigned int count;
+    unsigned int grain;
+    unsigned int chunks;
+    unsigned int next;
+    std::exception_ptr error;
+  };
+
+  ThreadPool(const ThreadPool &);
+  ThreadPool &operator=(const ThreadPool &);
+
+  void stop_workers();
+  void run_worker();
+  void work(Job &job);
+
+  std::vector<std::thread> workers_;
+  std::mutex mutex_;
+  std::mutex run_mutex_;
+  std::condition_variable start_;
+  std::condition_variable done_;
+  Job *job_;
+  unsigned long generation_;
+  unsigned int busy_;
+  bool stop_;
+};
+#endif
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <iostream>
 #include <exception>
 
@@ -7,12 +8,13 @@
 #include "FMatrix.hpp"
 
 #include "Huffile.hpp"
+#include "ThreadPool.hpp"
 
 const std::string full_help = 
   "\nThe program can encode any file via the Huffman entropy encoding.\n"
   "Additional it can transform a ppm file with the discrete cosiuns\n"
   "transformation.\n"
-  "It is able to Work with P1, P2, P3, P4, P5 and P6.\n"
+  "It is able to Work with P1, P2, P3, P4, P5, P6 and P7 (PAM).\n"
   "Also it can display the difference between two pictures that went through\n"
   "the DCT\n"  
   "\nUsage:\n"
@@ -20,6 +22,7 @@ const std::string full_help =
   "    Example:\n"
   "      main -h ./myFile.whatEver ./compressed.humdidum --en\n\n"
   "  main -d <input> <output> (--en|--de) [--detail] [--quality] [--quanti]\n"
+  "                                        [--integer] [--threads]\n"
   "    Example:\n"
   "      main -d ./myPicture.ppm ./compressed.humdi --en --quality 50\n\n"
   "  main -p <first> <second> <output> [--rmse]\n"
@@ -57,6 +60,13 @@ const std::string full_help =
   "                          24 35 55 64 81 104 113 92\n"
   "                          49 64 78 87 103 121 120 101\n"
   "                          72 92 95 98 112 100 103 99\n"
+  "    --integer           Transforms with integers instead of doubles, the\n"
+  "                        result is the same on every machine. Only used\n"
+  "                        when encoding, the file remembers the method.\n"
+  "    --threads <number>  Sets the amount of threads that transform the\n"
+  "                        picture, 0 uses one per core. At most 4 per core\n"
+  "                        are started. The result is the same with any\n"
+  "                        amount. (Default 0)\n"
   "\n  -p:    Selects the difference picture\n"
   "    <first>             Specifies the first Image (original)\n"
   "    <second>            Specifies the second Image (transformed)\n"
@@ -128,6 +138,7 @@ int dct(const int &argc, char** argv) {
   bool show_detail = false;
   bool encoding = true;
   unsigned char quality = 100;
+  DCT::Method method = DCT::FLOAT;
   Matrix<unsigned char> *quanti = NULL;
 
   if( argv[4][0] == '-'
@@ -185,6 +196,36 @@ int dct(const int &argc, char** argv) {
         && argv[i][6] == 'i'
         && argv[i][7] == 'l') {
       show_detail = true;
+    } else if( argv[i][0] == '-'
+        && argv[i][1] == '-'
+        && argv[i][2] == 'i'
+        && argv[i][3] == 'n'
+        && argv[i][4] == 't'
+        && argv[i][5] == 'e'
+        && argv[i][6] == 'g'
+        && argv[i][7] == 'e'
+        && argv[i][8] == 'r') {
+      method = DCT::ISLOW;
+    } else if( argv[i][0] == '-'
+        && argv[i][1] == '-'
+        && argv[i][2] == 't'
+        && argv[i][3] == 'h'
+        && argv[i][4] == 'r'
+        && argv[i][5] == 'e'
+        && argv[i][6] == 'a'
+        && argv[i][7] == 'd'
+        && argv[i][8] == 's') {
+      char *end = NULL;
+      long threads = (i + 1 < argc) ? strtol(argv[++i], &end, 10) : -1;
+
+      // a count that is no number or negative is rejected, a big one is
+      // capped by the pool
+      if(end == NULL || end == argv[i] || *end != '\0' || threads < 0) {
+        std::cout << full_help;
+        return 1;
+      }
+      ThreadPool::set_default_threads(
+          std::min<long>(threads, ThreadPool::get_max_threads()));
     } else {
       std::cout << full_help;
       return 1;
@@ -193,12 +234,13 @@ int dct(const int &argc, char** argv) {
   
   if(encoding) {
     PPMFile<double> *p = new PPMFile<double>(input); 
-    DCTFile *d = new DCTFile(p->get_mat_pic(), p->get_color_depth()); 
+    DCTFile *d = new DCTFile(p->release_mat_pic(), p->get_color_depth()); 
 
     if(quanti != NULL) {
       d->set_quantization(*quanti);
     }
     d->set_quality(quality); 
+    d->set_method(method);
     d->forward_dct();
     d->write_to(output);
 
@@ -214,7 +256,7 @@ int dct(const int &argc, char** argv) {
     DCTFile *d = new DCTFile(input);
     
     d->inverse_dct();
-    p->set_mat_pic(d->get_mat_pic(), d->get_color_depth());
+    p->set_mat_pic(d->release_mat_pic(), d->get_color_depth());
     p->write_to(output);
     
     if(show_detail) {
@@ -247,8 +289,8 @@ int diff_pic(const int &argc, char** argv) {
   PPMFile<double> *second_pic = new PPMFile<double>(second);
 
   DiffPic *diff_pic = new DiffPic();
-  diff_pic->set_pic_one(first_pic->get_mat_pic());
-  diff_pic->set_pic_two(second_pic->get_mat_pic());
+  diff_pic->set_pic_one(first_pic->release_mat_pic());
+  diff_pic->set_pic_two(second_pic->release_mat_pic());
   diff_pic->calculate();
   diff_pic->write_to(output);
 